@@ -1,270 +1,1660 @@
-#include <windows.h>
 #include <iostream>
 #include <cstdint>
-#include <sstream>
-#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
 
-#ifdef DLL_API
-#undef DLL_API
-#endif
-#define DLL_API extern "C" __declspec(dllimport)
-
-#include "DefMacro.h"
-#include "HTSoftDll.h"
-#include "HTHardDll.h"
-#include "MeasDll.h"
+#include "hantek_sdk.h"
+#include "hantek_sim.h"
+#include "mono_clock.h"
+#include "edge_scheduler.h"
+#include "utc_clock.h"
+#include "dcf77_frame.h"
+#include "dcf77_encoder.h"
+#include "tx_log.h"
+#include "latency_histogram.h"
+#include "stop_signal.h"
+#include "sdk_latency.h"
+#include "rt_thread.h"
+#include "period_servo.h"
+#include "pulse_program.h"
+#include "dds_state.h"
+#include "carrier_cal.h"
+#include "device_worker.h"
+#include "sdk_loader.h"
+#include "device_discovery.h"
+#include "device_recovery.h"
+#include "sdk_trace.h"
 
 //------------------------------------------------------------------------------
 
-#define LOAD_FUNC(h, name)                                                     \
-    do {                                                                       \
-        p_##name = reinterpret_cast<PFN_##name>(GetProcAddress(h, #name));     \
-        if (!p_##name) {                                                       \
-            std::cerr << "Missing function " #name " in DLL (GetLastError="    \
-                      << GetLastError() << ")\n";                              \
-            FreeLibrary(h);                                                    \
-            return 1;                                                          \
-        }                                                                      \
-    } while (0)
-
-#define DCF77_GET_BITS(frame, bit_pos, mask) ((((((uint16_t)frame[((bit_pos) / 8) + 1] << 8) | (uint16_t)frame[(bit_pos) / 8]) >> ((bit_pos) % 8)) & (mask)))
-
-#define DCF77_DECODER_FRAME_GET_FRAME_START(frame)          DCF77_GET_BITS(frame, 0, 0x01)
-#define DCF77_DECODER_FRAME_GET_WEATHER_INFO(frame)         (((DCF77_GET_BITS(frame, 1, 0x7F)) | (DCF77_GET_BITS(frame, 8, 0x3F) << 7)))
-#define DCF77_DECODER_FRAME_GET_AUX_ANTENNA(frame)          DCF77_GET_BITS(frame, 15, 0x01)
-#define DCF77_DECODER_FRAME_GET_TIME_CHANGE_ANN(frame)      DCF77_GET_BITS(frame, 16, 0x01)
-#define DCF77_DECODER_FRAME_GET_WINTER_TIME(frame)          DCF77_GET_BITS(frame, 17, 0x03)
-#define DCF77_DECODER_FRAME_GET_LEAP_SECOND(frame)          DCF77_GET_BITS(frame, 19, 0x01)
-#define DCF77_DECODER_FRAME_GET_TIME_START(frame)           DCF77_GET_BITS(frame, 20, 0x01)
-
-#define DCF77_DECODER_FRAME_GET_MINUTES_UNITS(frame)        DCF77_GET_BITS(frame, 21, 0x0F)
-#define DCF77_DECODER_FRAME_GET_MINUTES_TENS(frame)         DCF77_GET_BITS(frame, 25, 0x07)
-#define DCF77_DECODER_FRAME_GET_MINUTES_PARITY(frame)       DCF77_GET_BITS(frame, 28, 0x01)
-
-#define DCF77_DECODER_FRAME_GET_HOURS_UNITS(frame)          DCF77_GET_BITS(frame, 29, 0x0F)
-#define DCF77_DECODER_FRAME_GET_HOURS_TENS(frame)           DCF77_GET_BITS(frame, 33, 0x03)
-#define DCF77_DECODER_FRAME_GET_HOURS_PARITY(frame)         DCF77_GET_BITS(frame, 35, 0x01)
-
-#define DCF77_DECODER_FRAME_GET_DAY_UNITS(frame)            DCF77_GET_BITS(frame, 36, 0x0F)
-#define DCF77_DECODER_FRAME_GET_DAY_TENS(frame)             DCF77_GET_BITS(frame, 40, 0x03)
-#define DCF77_DECODER_FRAME_GET_WEEKDAY(frame)              DCF77_GET_BITS(frame, 42, 0x07)
-#define DCF77_DECODER_FRAME_GET_MONTH_UNITS(frame)          DCF77_GET_BITS(frame, 45, 0x0F)
-#define DCF77_DECODER_FRAME_GET_MONTH_TENS(frame)           DCF77_GET_BITS(frame, 49, 0x01)
-#define DCF77_DECODER_FRAME_GET_YEAR_UNITS(frame)           DCF77_GET_BITS(frame, 50, 0x0F)
-#define DCF77_DECODER_FRAME_GET_YEAR_TENS(frame)            DCF77_GET_BITS(frame, 54, 0x0F)
-#define DCF77_DECODER_FRAME_GET_DATE_PARITY(frame)          DCF77_GET_BITS(frame, 58, 0x01)
+#define SDK_DECLARE_FUNC(name, required) static PFN_##name p_##name = nullptr;
+#define SDK_BIND_LAZY_FUNC(name, required) p_##name = SdkLazy<SdkExport::name, PFN_##name>::call;
+#define SDK_BIND_SIM_FUNC(name, required) p_##name = sim_##name;
+#define SDK_BIND_TRACE_FUNC(name, required)                         \
+    SdkTraced<SdkExport::name, PFN_##name>::next = p_##name;        \
+    p_##name = SdkTraced<SdkExport::name, PFN_##name>::call;
 
 //------------------------------------------------------------------------------
 
 const uint64_t TEST_DCF77_FRAME             = 0b00101001011100000010100010010010001000100110010001101001000;
+static_assert(dcf77_frame_valid(TEST_DCF77_FRAME), "TEST_DCF77_FRAME parity and ranges");
+static_assert(dcf77_decode(TEST_DCF77_FRAME).year == 2025 && dcf77_decode(TEST_DCF77_FRAME).month == 11 &&
+              dcf77_decode(TEST_DCF77_FRAME).day == 24 && dcf77_decode(TEST_DCF77_FRAME).weekday == 1,
+              "TEST_DCF77_FRAME date");
+static_assert(dcf77_decode(TEST_DCF77_FRAME).hour == 22 && dcf77_decode(TEST_DCF77_FRAME).minute == 48 &&
+              !dcf77_decode(TEST_DCF77_FRAME).summer, "TEST_DCF77_FRAME time");
+static_assert(dcf77_encode(dcf77_decode(TEST_DCF77_FRAME)) ==
+              (TEST_DCF77_FRAME & ~dcf77_from_air_order(Dcf77Weather::MASK)), "TEST_DCF77_FRAME re-encodes");
+
 const unsigned int INITIAL_ERROR_TIME_MS    = 3000;
 const unsigned int INITIAL_FRAME_START_MS   = 1800;
 const unsigned int BIT_0_PULSE_MS           = 100;
 const unsigned int BIT_1_PULSE_MS           = 200;
-const unsigned int BIT_TOTAL_MS             = 970;
-const unsigned int MINUTE_MARKER_MS         = 900;
+const unsigned int BIT_PERIOD_MS            = 1000;
+const unsigned int SECONDS_PER_MINUTE       = 60;
 
 const float CARIER_FREQUENCY_HZ             = 77500.0f; 
 const unsigned int AMPLITUDE_LOW            = 50;    
 const unsigned int AMPLITUDE_HIGH           = 1500;  
 
+const float AM_DEPTH                        = 1.0f - static_cast<float>(AMPLITUDE_LOW) / AMPLITUDE_HIGH;
+const double AM_MODULATION_HZ               = 0.0;  // modulator held still, envelope level unverified
+
+const uint32_t BENCH_DEFAULT_MINUTES        = 2;
+
+const int64_t DEVICE_COMPLETION_TIMEOUT_NS  = 1000 * NS_PER_MS;    // past the edge deadline
+
+const USHORT DDS_CMD_CONTINUOUS             = 0;
+const USHORT DDS_CMD_BURST                  = 4;    // "Output N Cyc sine wave" sample of the SDK manual
+const unsigned int BURST_ARM_LEAD_MS        = 30;   // mode and amplitude written this long before the trigger
+
+const PulseLevels PULSE_LEVELS              = {AMPLITUDE_HIGH, AMPLITUDE_LOW,
+                                               BIT_0_PULSE_MS * NS_PER_MS, BIT_1_PULSE_MS * NS_PER_MS};
+
 //------------------------------------------------------------------------------
 
-// Scope / hardware
-typedef WORD (WINAPI *PFN_dsoHTSearchDevice)(short *pDevInfo);
-typedef WORD (WINAPI *PFN_dsoHTDeviceConnect)(WORD nDeviceIndex);
-typedef WORD (WINAPI *PFN_dsoInitHard)(WORD nDeviceIndex);
+enum class TransmitEngine : uint8_t
+{
+    HostTimed,  // one ddsSDKSetAmp per edge
+    Burst,      // --burst: every reduction is a DDS burst of an exact cycle count
+    Am,         // --am: built-in AM configured once, one wave type switch per edge
+};
+
+static const char *engine_name(TransmitEngine engine)
+{
+    switch (engine)
+    {
+    case TransmitEngine::HostTimed: return "host timed";
+    case TransmitEngine::Burst:     return "burst";
+    case TransmitEngine::Am:        return "am";
+    }
+    return "?";
+}
+
+// Device of a --fanout group and the shift of its frames against the group's time
+struct FanoutMember
+{
+    WORD    slot;
+    int32_t offset_minutes;
+};
+
+struct TransmitOptions
+{
+    bool utc_aligned = false;   // --utc: bit 0 of every frame on a true UTC minute boundary
+    bool live_frames = false;   // --live: encode every minute from the system clock (implies --utc)
+    TransmitEngine engine = TransmitEngine::HostTimed;
+    uint32_t minutes = 0;       // --minutes: stop after this many minutes, 0 runs until Ctrl-C
+    bool bench_engines = false; // --bench-engines: run host timed, AM and burst in turn and compare
+    bool calibrate = false;     // --calibrate: measure the carrier on the frequency counter and cache the setting
+    bool use_calibration = true;    // --no-cal: ignore the cached setting
+    bool device_worker = false; // --worker: host timed / AM edges are issued by a device worker thread
+    float carrier_hz = CARIER_FREQUENCY_HZ;     // DDS setting, from the calibration cache when present
+    int device = -1;            // --device: slot to transmit on, -1 takes the first one found
+    FanoutMember fanout[DEVICE_SLOTS];  // --fanout <slot>[:<minutes>],...: transmit on all of them
+    uint32_t fanout_count = 0;
+    bool fanout_all = false;    // --fanout all: every device found
+    bool reconnect = true;      // --no-reconnect: stop on a lost device instead of reconnecting
+    RecoveryTuning recovery;    // --reconnect-timeout <s>
+    const char *sdk_trace = nullptr;    // --trace-sdk <file>: record every SDK call
+    const char *tx_trace = nullptr;     // --tx-trace <dir>: daily binary trace of edges and frames
+
+    SdkLatencyTuning sdk_latency;   // --latency-gain / --latency-point / --latency-max-ms / --no-latency-comp
+    RtThreadConfig rt;              // --no-rt / --no-mlock / --cpu <mask>
+    PeriodServoTuning servo;        // --no-servo
 
-// DDS / generator
-typedef WORD (WINAPI *PFN_ddsSDKSetWaveType)(WORD nDeviceIndex, WORD nWaveType);
-typedef WORD (WINAPI *PFN_ddsSDKSetFre)(WORD nDeviceIndex, float fFre);
-typedef WORD (WINAPI *PFN_ddsSDKSetAmp)(WORD nDeviceIndex, WORD nAmp);
-typedef WORD (WINAPI *PFN_ddsSDKSetOffset)(WORD nDeviceIndex, short nOffset);
-typedef WORD (WINAPI *PFN_ddsSetOnOff)(WORD nDeviceIndex, WORD nOnOff);
+#ifdef _WIN32
+    bool simulated = false;         // --sim: simulated device instead of HTHardDll.dll
+#else
+    bool simulated = true;          // no SDK outside Windows
+#endif
+    SimConfig sim;                  // --sim-latency <min_ms>:<max_ms> / --sim-devices <n> / --sim-disconnect <at_s>:<for_s>
+};
 
-static PFN_dsoHTSearchDevice  p_dsoHTSearchDevice  = nullptr;
-static PFN_dsoHTDeviceConnect p_dsoHTDeviceConnect = nullptr;
-static PFN_dsoInitHard        p_dsoInitHard        = nullptr;
+//------------------------------------------------------------------------------
 
-static PFN_ddsSDKSetWaveType  p_ddsSDKSetWaveType  = nullptr;
-static PFN_ddsSDKSetFre       p_ddsSDKSetFre       = nullptr;
-static PFN_ddsSDKSetAmp       p_ddsSDKSetAmp       = nullptr;
-static PFN_ddsSDKSetOffset    p_ddsSDKSetOffset    = nullptr;
-static PFN_ddsSetOnOff        p_ddsSetOnOff        = nullptr;
+SDK_USED_EXPORTS(SDK_DECLARE_FUNC)
 
 //------------------------------------------------------------------------------
 
-static void modulate_dcf77(WORD dev, uint64_t dcf_frame)
+static double ns_to_ms(int64_t ns)
 {
-    // Initial idle: generator OFF for 3 s - force receiver to enter error state
-    p_ddsSetOnOff(dev, 0);
-    Sleep(INITIAL_ERROR_TIME_MS);
+    return static_cast<double>(ns) / NS_PER_MS;
+}
 
-    // Start frame
-    p_ddsSetOnOff(dev, 1);
-    Sleep(INITIAL_FRAME_START_MS);
+static void unload_sdk()
+{
+    if (sdk_trace_active())
+    {
+        const SdkTraceStats stats = sdk_trace_close();
+        std::cout << "SDK trace: " << stats.records << " calls written, " << stats.dropped << " dropped\n";
+    }
+
+    sdk_unload();
+}
 
-    while (true)
+#ifdef _WIN32
+// Only HTHardDll.dll is loaded here. The entry points are bound to lazy thunks,
+// so exports of features this run does not use are never looked up.
+static bool load_sdk_dll()
+{
+    if (!sdk_load(SdkDll::HTHardDll))
     {
-        // Process bits from MSB (bit 58) to LSB (bit 0)
-        for (int8_t bit_idx = 58; bit_idx >= 0; bit_idx--)
-        {
-            uint8_t bit_value = (dcf_frame >> bit_idx) & 1u;
+        std::cerr << "Make sure HTHardDll.dll is next to the executable "
+                     "and has matching architecture.\n";
+        return false;
+    }
 
-            uint16_t pulse_duration_ms   = (bit_value == 0u) ? BIT_0_PULSE_MS : BIT_1_PULSE_MS;
-            uint16_t silence_duration_ms = BIT_TOTAL_MS - pulse_duration_ms;
+    SDK_USED_EXPORTS(SDK_BIND_LAZY_FUNC)
 
-            std::cout << "Transmitting bit " << static_cast<int>(bit_value)
-                      << " (pulse " << pulse_duration_ms << " ms, silence "
-                      << silence_duration_ms << " ms) bit idx : " << static_cast<int>(58 - bit_idx) << "\n";
+    // Without these nothing can be sent, fail now rather than on the first edge
+    bool ok = true;
+#define SDK_CHECK_REQUIRED(name, required) ok = (!required || sdk_available(SdkExport::name)) && ok;
+    SDK_USED_EXPORTS(SDK_CHECK_REQUIRED)
+#undef SDK_CHECK_REQUIRED
 
-            p_ddsSDKSetAmp(dev, AMPLITUDE_LOW);       
-            Sleep(pulse_duration_ms);
-            
-            p_ddsSDKSetAmp(dev, AMPLITUDE_HIGH);       
-            Sleep(silence_duration_ms);
-        }
+    if (!ok)
+        unload_sdk();
+    return ok;
+}
+#endif
 
-        std::cout << "Transmitting sync bit (silence " << MINUTE_MARKER_MS << " ms)\n";
+static void bind_sim_sdk(const SimConfig &config)
+{
+    sim_configure(config);
 
-        // After full 59-bit frame: extra minute marker
-        Sleep(MINUTE_MARKER_MS);
-    }
+    SDK_USED_EXPORTS(SDK_BIND_SIM_FUNC)
 }
 
-static std::string dcf77_frame_to_string(uint64_t frame_bits)
+// Every entry point bound so far gets the recording shim in front
+static bool trace_sdk(const char *path)
 {
-    uint8_t frame[9] = {0};
+    if (!sdk_trace_open(path))
+        return false;
+
+    SDK_USED_EXPORTS(SDK_BIND_TRACE_FUNC)
+
+    std::cout << "Recording SDK calls to " << path << "\n";
+    return true;
+}
 
-    for (int bit = 0; bit <= 58; ++bit)
+static bool bind_sdk(const TransmitOptions &options)
+{
+    if (options.simulated)
     {
-        if ((frame_bits >> (58 - bit)) & 1ULL)
-        {
-            frame[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
-        }
+        std::cout << "Using simulated device, SDK call latency " << ns_to_ms(options.sim.latency_min_ns) << "-"
+                  << ns_to_ms(options.sim.latency_max_ns) << " ms\n";
+        if (options.sim.disconnect_ns)
+            std::cout << "Simulated USB disconnect " << ns_to_ms(options.sim.disconnect_at_ns) / 1000.0 << " s after start for "
+                      << ns_to_ms(options.sim.disconnect_ns) / 1000.0 << " s\n";
+        bind_sim_sdk(options.sim);
+        return true;
     }
 
-    uint8_t min_units = DCF77_DECODER_FRAME_GET_MINUTES_UNITS(frame);
-    uint8_t min_tens  = DCF77_DECODER_FRAME_GET_MINUTES_TENS(frame);
-    int minute = min_units + 10 * min_tens;
+#ifdef _WIN32
+    return load_sdk_dll();
+#else
+    return false;
+#endif
+}
+
+static bool load_sdk(const TransmitOptions &options)
+{
+    if (!bind_sdk(options))
+        return false;
 
-    uint8_t hour_units = DCF77_DECODER_FRAME_GET_HOURS_UNITS(frame);
-    uint8_t hour_tens  = DCF77_DECODER_FRAME_GET_HOURS_TENS(frame);
-    int hour = hour_units + 10 * hour_tens;
+    if (options.sdk_trace && !trace_sdk(options.sdk_trace))
+    {
+        unload_sdk();
+        return false;
+    }
+    return true;
+}
 
-    uint8_t day_units = DCF77_DECODER_FRAME_GET_DAY_UNITS(frame);
-    uint8_t day_tens  = DCF77_DECODER_FRAME_GET_DAY_TENS(frame);
-    int day = day_units + 10 * day_tens;
+// The simulated device implements every entry point, the DLL may lack optional ones
+static bool sdk_supports(const TransmitOptions &options, std::initializer_list<SdkExport> exports)
+{
+    if (options.simulated)
+        return true;
 
-    uint8_t month_units = DCF77_DECODER_FRAME_GET_MONTH_UNITS(frame);
-    uint8_t month_tens  = DCF77_DECODER_FRAME_GET_MONTH_TENS(frame);
-    int month = month_units + 10 * month_tens;
+    bool ok = true;
+    for (SdkExport id : exports)
+        ok = sdk_available(id) && ok;
+    return ok;
+}
 
-    uint8_t year_units = DCF77_DECODER_FRAME_GET_YEAR_UNITS(frame);
-    uint8_t year_tens  = DCF77_DECODER_FRAME_GET_YEAR_TENS(frame);
-    int year = 2000 + year_units + 10 * year_tens;
+static bool engine_supported(const TransmitOptions &options, TransmitEngine engine)
+{
+    switch (engine)
+    {
+    case TransmitEngine::Burst:
+        return sdk_supports(options, {SdkExport::ddsSetCmd, SdkExport::ddsSDKSetBurstNum, SdkExport::ddsEmitSingle});
+    case TransmitEngine::Am:
+        return sdk_supports(options, {SdkExport::ddsSetFAOC, SdkExport::ddsSetAMFMFreq});
+    case TransmitEngine::HostTimed:
+        break;
+    }
+    return true;
+}
 
-    std::ostringstream ss;
-    ss << std::setfill('0')
-       << year << "-"
-       << std::setw(2) << month << "-"
-       << std::setw(2) << day << " "
-       << std::setw(2) << hour << ":"
-       << std::setw(2) << minute;
+static void print_sdk_load_stats()
+{
+    const SdkLoadStats &stats = sdk_load_stats();
 
-    return ss.str();
+    std::cout << "SDK startup:";
+    for (size_t i = 0; i < SDK_DLL_COUNT; ++i)
+    {
+        if (stats.load_ns[i])
+            std::cout << " " << sdk_dll_file(static_cast<SdkDll>(i)) << " loaded in " << ns_to_ms(stats.load_ns[i])
+                      << " ms,";
+    }
+    std::cout << " " << stats.resolved << " of " << SDK_EXPORT_COUNT << " exports resolved in "
+              << ns_to_ms(stats.resolve_ns) << " ms, " << stats.missing << " missing\n";
 }
 
 //------------------------------------------------------------------------------
 
-int main()
+// One device of a --fanout group, the first one is also TransmitContext::dds
+struct FanoutDevice
 {
-    std::cout << "Hantek DCF77 generator\n";
+    DdsStateCache *dds;
+    int32_t offset_minutes;
+    PulseProgram program;           // this device's frame for the current minute
+    bool     queued[2];             // START / END of the current second on the worker
+    uint64_t seq[2];
+    int64_t  planned_ns[2];
+    EdgeLatenessStats skew;         // lateness - mean lateness of the group, current minute
+    EdgeLatenessStats total_skew;
+};
+
+// State shared by the modulation engines
+struct TransmitContext
+{
+    WORD dev;
+    DdsStateCache &dds;
+    const TransmitOptions &options;
+    EdgeScheduler &scheduler;
+    const FrameDoubleBuffer &frames;
+    int64_t utc_start_ns;
+    TxLogger &log;
+    EdgeTimingHistograms &histograms;
+    SdkLatencyEstimator &sdk_latency;
+    PeriodServo &servo;
+    PulseProgram program;           // minute being transmitted
+    EdgeLatenessStats edge_error;   // predicted amplitude change - deadline, current minute
+    EdgeLatenessStats pulse_width_error;    // burst mode: predicted width - nominal, current minute
+    EdgeLatenessStats total_edge_error;     // edge_error over the whole run
+    uint64_t direct_calls;                  // SDK calls that bypass the state cache (ddsEmitSingle)
+    std::vector<FanoutDevice> *fanout;      // --fanout group, null for a single device
+    EdgeLatenessStats spread;               // fan-out: latest - earliest device per edge, current minute
+    EdgeLatenessStats total_spread;
+    DeviceRecovery *recovery;               // reconnects a lost device, null where not supported
+    uint32_t missed_edges;                  // skipped during the current outage
+    uint64_t total_missed_edges;
+};
+
+// Edge timing of one run, compared across engines by --bench-engines
+struct TransmitSummary
+{
+    EdgeLatenessStats edge_error;
+    LatencyPercentiles lateness;
+    LatencyPercentiles sdk_call;
+    LatencyPercentiles change_error;
+    uint64_t edge_calls;
+};
+
+// Reconnecting gave up
+static bool device_lost(const TransmitContext &ctx)
+{
+    return ctx.recovery && ctx.recovery->state() == RecoveryState::Failed;
+}
+
+// The engines stop on Ctrl-C, after --minutes or when the device is gone for good
+static bool keep_running(const TransmitContext &ctx, uint64_t minute)
+{
+    return !stop_requested() && !device_lost(ctx) && (ctx.options.minutes == 0 || minute < ctx.options.minutes);
+}
+
+// Frame announcing the end of the given transmitted minute, encoded inline if the encoder fell behind
+static Dcf77Frame frame_for_minute(TransmitContext &ctx, uint64_t minute)
+{
+    const int64_t utc_minute_ns = ctx.utc_start_ns + static_cast<int64_t>(minute + 1) * NS_PER_MINUTE;
+
+    Dcf77Frame frame;
+    ctx.frames.latest(frame);
 
-    HMODULE hHard = LoadLibraryA("HTHardDll.dll");
-    if (!hHard)
+    if (ctx.options.live_frames && frame.utc_minute_ns != utc_minute_ns)
     {
-        DWORD err = GetLastError();
-        std::cerr << "Cannot load HTHardDll.dll, GetLastError = "
-                  << err << "\n";
-        std::cerr << "Make sure HTHardDll.dll is next to the executable "
-                     "and has matching architecture.\n";
-        return 1;
+        ctx.log.log_notice("Frame encoder behind schedule, encoding minute inline");
+        frame = {utc_minute_ns, dcf77_encode_frame(utc_minute_ns)};
     }
 
-    LOAD_FUNC(hHard, dsoHTSearchDevice);
-    LOAD_FUNC(hHard, dsoHTDeviceConnect);
-    LOAD_FUNC(hHard, dsoInitHard);
+    ctx.log.log_frame(frame.utc_minute_ns, frame.bits, utc_now_ns());
+    return frame;
+}
+
+static void log_minute_stats(TransmitContext &ctx)
+{
+    const EdgeLatenessStats &stats = ctx.scheduler.minute_stats();
+    const EdgeLatenessStats &phase = ctx.scheduler.minute_phase_stats();
 
-    LOAD_FUNC(hHard, ddsSDKSetWaveType);
-    LOAD_FUNC(hHard, ddsSDKSetFre);
-    LOAD_FUNC(hHard, ddsSDKSetAmp);
-    LOAD_FUNC(hHard, ddsSDKSetOffset);
-    LOAD_FUNC(hHard, ddsSetOnOff);
+    ctx.log.log_minute({ctx.scheduler.utc_locked(),
+                        stats.min_ns, stats.mean_ns(), stats.max_ns,
+                        phase.min_ns, phase.mean_ns(), phase.max_ns,
+                        ctx.edge_error.min_ns, ctx.edge_error.mean_ns(), ctx.edge_error.max_ns,
+                        ctx.sdk_latency.estimate_ns(), ctx.sdk_latency.deviation_ns(), ctx.sdk_latency.lead_ns(),
+                        ctx.servo.minute_period_ppm(), ctx.servo.total_period_ppm(), ctx.servo.trim_ns(),
+                        ctx.pulse_width_error.count, ctx.pulse_width_error.min_ns,
+                        ctx.pulse_width_error.mean_ns(), ctx.pulse_width_error.max_ns});
 
-    short devInfo[32] = {0};
-    WORD rc = p_dsoHTSearchDevice(devInfo);
+    ctx.edge_error.reset();
+    ctx.pulse_width_error.reset();
+    ctx.servo.begin_minute();
+}
 
-    if (rc != HT_OK)
+// The single DDS write that changes the output for one program event
+static DeviceCommandKind edge_command(const TransmitContext &ctx, const PulseEvent &event, uint32_t &value)
+{
+    if (!event.on)
     {
-        std::cerr << "dsoHTSearchDevice rc = " << rc << " (error)\n";
-        FreeLibrary(hHard);
-        return 1;
+        value = 0;
+        return DeviceCommandKind::SetOnOff;
     }
 
-    int devCount = 0;
-    for (int i = 0; i < 32; ++i)
+    // Carrier and depth are already set, only the modulating state changes
+    if (ctx.options.engine == TransmitEngine::Am)
     {
-        if (devInfo[i] != 0)
-            ++devCount;
+        value = event.amplitude_mv < AMPLITUDE_HIGH ? WAVE_AM : WAVE_SINE;
+        return DeviceCommandKind::SetWaveType;
     }
 
-    std::cout << "Found: " << devCount << " devices\n"; 
-    if (devCount == 0)
+    value = event.amplitude_mv;
+    return DeviceCommandKind::SetAmplitude;
+}
+
+// Bookkeeping of one played event from the timestamps around its call, due_ns
+// is the moment the call was scheduled to start. Returns the predicted moment
+// the output changed.
+static int64_t record_edge(TransmitContext &ctx, const PulseEvent &event, int64_t planned_ns, int64_t due_ns,
+                           int64_t call_ns, int64_t done_ns, bool sent, uint32_t rc, bool logged = true)
+{
+    // A write the cache dropped says nothing about the USB latency
+    if (sent)
+        ctx.sdk_latency.add(done_ns - call_ns);
+
+    const int64_t effective_ns = ctx.sdk_latency.effective_ns(call_ns, done_ns);
+
+    ctx.edge_error.add(effective_ns - planned_ns);
+    ctx.total_edge_error.add(effective_ns - planned_ns);
+    ctx.histograms.lateness.record(call_ns - due_ns);
+    ctx.histograms.sdk_call.record(done_ns - call_ns);
+    ctx.histograms.change_error.record(std::llabs(effective_ns - planned_ns));
+    if (logged)
+        ctx.log.log_edge(event.second, event.bit_value, event.edge, planned_ns, effective_ns, rc);
+
+    return effective_ns;
+}
+
+// Edge skipped because the device is being reconnected
+static void count_missed_edge(TransmitContext &ctx)
+{
+    if (ctx.missed_edges == 0)
+        ctx.log.log_notice("Device lost, reconnecting");
+    ++ctx.missed_edges;
+}
+
+// False while the device is being reconnected, the edge is then skipped. The
+// schedule keeps running meanwhile, so the carrier comes back at the right bit
+// of the current minute instead of with a new preamble.
+static bool device_online(TransmitContext &ctx, const PulseEvent &event)
+{
+    if (!ctx.recovery)
+        return true;
+
+    switch (ctx.recovery->state())
     {
-        FreeLibrary(hHard);
-        return 0;
+    case RecoveryState::Online:
+        return true;
+
+    case RecoveryState::Recovered:
+    {
+        const OutageRecord outage = ctx.recovery->resume(mono_now_ns());
+
+        ctx.log.log_outage({event.second, outage.attempts, ctx.missed_edges, outage.recovery_ns, outage.outage_ns});
+        ctx.total_missed_edges += ctx.missed_edges;
+        ctx.missed_edges = 0;
+        return true;
     }
 
-    WORD dev = 0; // first device
+    case RecoveryState::Recovering:
+    case RecoveryState::Failed:
+        break;
+    }
+
+    count_missed_edge(ctx);
+    return false;
+}
+
+// Play one program event at planned_ns (shifted by the servo trim). The call is
+// issued early by the predicted SDK latency and timestamped on both sides to
+// refine that prediction. False if the edge was skipped, else effective_ns is
+// the predicted moment the output changed.
+static bool issue_edge(TransmitContext &ctx, const PulseEvent &event, int64_t planned_ns, int64_t trim_ns,
+                       int64_t &effective_ns)
+{
+    const int64_t due_ns = planned_ns + trim_ns - ctx.sdk_latency.lead_ns();
+    ctx.scheduler.wait_until(due_ns);
+
+    if (!device_online(ctx, event))
+        return false;
+
+    uint32_t value = 0;
+    const DeviceCommandKind kind = edge_command(ctx, event, value);
+    const uint64_t issued        = ctx.dds.stats().issued;
+
+    const int64_t call_ns = mono_now_ns();
+    const WORD rc         = device_command_execute(ctx.dds, kind, value);
+    const int64_t done_ns = mono_now_ns();
 
-    rc = p_dsoHTDeviceConnect(dev);
-    std::cout << "dsoHTDeviceConnect rc = " << rc << "\n";
-    if (rc != HT_OK)
+    // A failed call's duration is a USB timeout, not a latency sample
+    effective_ns = record_edge(ctx, event, planned_ns, due_ns, call_ns, done_ns,
+                               ctx.dds.stats().issued != issued && rc == HT_OK, rc);
+
+    if (rc != HT_OK && ctx.recovery)
     {
-        std::cerr << "DeviceConnect fail rc=" << rc << "\n";
-        FreeLibrary(hHard);
-        return 1;
+        ctx.log.log_notice("SDK call failed");
+        ctx.recovery->begin(call_ns);
     }
+    return true;
+}
+
+// Amplitude edges report no status, a lost device is found by the recovery
+// thread probing it in the quiet part of the second after its END edge
+static void probe_device(TransmitContext &ctx)
+{
+    if (ctx.recovery && ctx.recovery->state() == RecoveryState::Online)
+        ctx.recovery->probe(mono_now_ns());
+}
+
+// Edge queued on the device worker, completed once its call returned
+struct PendingEdge
+{
+    const PulseEvent *event;
+    int64_t planned_ns;
+    uint64_t seq;
+};
+
+// Queue one event with the same lead as issue_edge
+static bool submit_edge(TransmitContext &ctx, DeviceWorker &worker, const PulseEvent &event, int64_t planned_ns,
+                        int64_t trim_ns, uint64_t &seq)
+{
+    uint32_t value = 0;
+    const DeviceCommandKind kind = edge_command(ctx, event, value);
+
+    return worker.submit(kind, value, planned_ns + trim_ns - ctx.sdk_latency.lead_ns(), seq);
+}
 
-    rc = p_dsoInitHard(dev);
-    std::cout << "dsoInitHard rc = " << rc << "\n";
-    if (rc != HT_OK)
+// Completion of a queued command, older ones left by a timeout are skipped
+static bool wait_completion(DeviceWorker &worker, uint64_t seq, int64_t planned_ns, DeviceCompletion &completion)
+{
+    const int64_t give_up_ns = planned_ns + DEVICE_COMPLETION_TIMEOUT_NS;
+
+    while (worker.wait(completion, give_up_ns - mono_now_ns()))
     {
-        std::cerr << "InitHard fail rc=" << rc << "\n";
-        FreeLibrary(hHard);
-        return 1;
+        if (completion.seq == seq)
+            return true;
     }
+    return false;
+}
 
-    rc = p_ddsSDKSetWaveType(dev, WAVE_SINE);
-    std::cout << "ddsSDKSetWaveType rc = " << rc << "\n";
+// Collect the completions of the queued edges, in submission order. An edge
+// that timed out is skipped, its late completion is discarded by the next wait.
+// A failed call hands the device to the recovery once the worker is idle.
+static void complete_edges(TransmitContext &ctx, DeviceWorker &worker, const PendingEdge *pending, uint32_t count,
+                           uint64_t minute)
+{
+    int64_t failed_ns = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const PendingEdge &edge = pending[i];
 
-    rc = p_ddsSDKSetFre(dev, CARIER_FREQUENCY_HZ);   // 77.5 kHz
-    std::cout << "ddsSDKSetFre rc = " << rc << "\n";
+        DeviceCompletion completion;
+        if (!wait_completion(worker, edge.seq, edge.planned_ns, completion))
+        {
+            ctx.log.log_notice("Device worker did not complete an edge in time");
+            continue;
+        }
+
+        if (completion.skipped)
+        {
+            count_missed_edge(ctx);
+            continue;
+        }
 
-    rc = p_ddsSDKSetAmp(dev, AMPLITUDE_HIGH);
-    std::cout << "ddsSDKSetAmp rc = " << rc << "\n";
+        if (completion.rc != HT_OK && failed_ns == 0)
+            failed_ns = completion.call_ns;
 
-    rc = p_ddsSDKSetOffset(dev, 0);
-    std::cout << "ddsSDKSetOffset rc = " << rc << "\n";
+        ctx.scheduler.record_wait(completion.due_ns, completion.call_ns, completion.call_utc_ns);
 
-    std::cout << "Ctrl-C to stop\n"; 
+        const int64_t effective_ns = record_edge(ctx, *edge.event, edge.planned_ns, completion.due_ns,
+                                                 completion.call_ns, completion.done_ns, completion.sent,
+                                                 completion.rc);
+
+        if (edge.event->edge == PULSE_EDGE_START)
+            ctx.servo.add_second_start(minute * SECONDS_PER_MINUTE + edge.event->second,
+                                       ctx.scheduler.since_epoch_ns(effective_ns));
+    }
+
+    if (failed_ns != 0 && ctx.recovery && ctx.recovery->state() == RecoveryState::Online)
+    {
+        ctx.log.log_notice("SDK call failed");
+        ctx.recovery->begin(failed_ns);
+    }
+}
+
+static void transmit_host_timed(TransmitContext &ctx)
+{
+    EdgeScheduler &scheduler = ctx.scheduler;
+
+    sleep_until_ns(scheduler.deadline_ns(0, 0) - static_cast<int64_t>(INITIAL_FRAME_START_MS) * NS_PER_MS);
+
+    // Start frame
+    ctx.dds.set_on_off(true);
+
+    // With --worker the calls leave this thread, it only plans and books edges
+    // Same priority as this thread but not its CPU pin, both have to run side
+    // by side. Memory is already locked process wide.
+    RtThreadConfig worker_rt = ctx.options.rt;
+    worker_rt.cpu_mask    = 0;
+    worker_rt.lock_memory = false;
+
+    DeviceWorker worker(ctx.dds, ctx.recovery);
+    if (ctx.options.device_worker)
+        worker.start(worker_rt);
+
+    PendingEdge pending[2];
+    uint32_t pending_count = 0;
+
+    for (uint64_t minute = 0; keep_running(ctx, minute); ++minute)
+    {
+        scheduler.begin_minute();
+
+        const Dcf77Frame frame = frame_for_minute(ctx, minute);
+
+        // Resolve the whole minute up front, the edge loop below only walks the events
+        compile_pulse_program(frame.bits, PULSE_LEVELS, ctx.program);
+
+        const int64_t minute_ns = static_cast<int64_t>(minute * SECONDS_PER_MINUTE) * NS_PER_S;
+        int64_t trim_ns = 0;
+
+        for (uint32_t i = 0; i < ctx.program.count && !stop_requested() && !device_lost(ctx); ++i)
+        {
+            const PulseEvent &event = ctx.program.events[i];
+
+            // Second 59 stays unmodulated, the carrier is already at full amplitude
+            if (event.edge == PULSE_EDGE_MARKER)
+                continue;
+
+            if (event.edge == PULSE_EDGE_START)
+            {
+                // Follow UTC steps and slews before the second starts, both edges
+                // then move with the same trim so the pulse width stays exact
+                scheduler.resync();
+                trim_ns = ctx.servo.trim_ns();
+            }
+
+            const int64_t planned_ns = scheduler.epoch_deadline_ns(minute_ns + event.offset_ns);
+
+            if (ctx.options.device_worker)
+            {
+                // Both edges of a second are queued together, then booked while the worker waits
+                uint64_t seq = 0;
+                if (device_online(ctx, event))
+                {
+                    if (submit_edge(ctx, worker, event, planned_ns, trim_ns, seq))
+                        pending[pending_count++] = {&event, planned_ns, seq};
+                    else
+                        ctx.log.log_notice("Device worker queue full, edge dropped");
+                }
+
+                if (event.edge == PULSE_EDGE_END)
+                {
+                    complete_edges(ctx, worker, pending, pending_count, minute);
+                    pending_count = 0;
+                    probe_device(ctx);
+                }
+                continue;
+            }
+
+            int64_t effective_ns = 0;
+            if (!issue_edge(ctx, event, planned_ns, trim_ns, effective_ns))
+                continue;
+
+            if (event.edge == PULSE_EDGE_START)
+                ctx.servo.add_second_start(minute * SECONDS_PER_MINUTE + event.second, scheduler.since_epoch_ns(effective_ns));
+            else
+                probe_device(ctx);
+        }
+
+        log_minute_stats(ctx);
+    }
+
+    worker.stop();
+}
+
+// Book the START and END edges of one second on every device of the group.
+// Each device's lateness is compared with the group mean for the same edge.
+static void complete_fanout_second(TransmitContext &ctx, std::vector<std::unique_ptr<DeviceWorker>> &workers,
+                                   uint64_t minute, uint32_t start_index)
+{
+    std::vector<FanoutDevice> &devices = *ctx.fanout;
+
+    for (uint32_t edge = 0; edge < 2; ++edge)
+    {
+        int64_t lateness_ns[DEVICE_SLOTS];
+        bool    completed[DEVICE_SLOTS];
+        int64_t lateness_sum_ns   = 0;
+        int64_t effective_sum_ns  = 0;
+        int64_t earliest_ns       = INT64_MAX;
+        int64_t latest_ns         = INT64_MIN;
+        int64_t count             = 0;
+
+        for (size_t d = 0; d < devices.size(); ++d)
+        {
+            FanoutDevice &device = devices[d];
+            const PulseEvent &event = device.program.events[start_index + edge];
+
+            completed[d] = false;
+
+            DeviceCompletion completion;
+            if (!device.queued[edge] || !wait_completion(*workers[d], device.seq[edge], device.planned_ns[edge], completion))
+            {
+                ctx.log.log_notice("Fan-out device did not complete an edge in time");
+                continue;
+            }
+
+            ctx.scheduler.record_wait(completion.due_ns, completion.call_ns, completion.call_utc_ns);
+
+            // Only the first device's edges are printed, the others show up in the skew
+            const int64_t effective_ns = record_edge(ctx, event, device.planned_ns[edge], completion.due_ns,
+                                                     completion.call_ns, completion.done_ns, completion.sent,
+                                                     completion.rc, d == 0);
+
+            lateness_ns[d]  = effective_ns - device.planned_ns[edge];
+            completed[d]    = true;
+            lateness_sum_ns  += lateness_ns[d];
+            effective_sum_ns += effective_ns;
+            earliest_ns = std::min(earliest_ns, lateness_ns[d]);
+            latest_ns   = std::max(latest_ns, lateness_ns[d]);
+            ++count;
+        }
+
+        if (!count)
+            continue;
+
+        const int64_t mean_ns = lateness_sum_ns / count;
+        for (size_t d = 0; d < devices.size(); ++d)
+        {
+            if (!completed[d])
+                continue;
+
+            devices[d].skew.add(lateness_ns[d] - mean_ns);
+            devices[d].total_skew.add(lateness_ns[d] - mean_ns);
+        }
+
+        ctx.spread.add(latest_ns - earliest_ns);
+        ctx.total_spread.add(latest_ns - earliest_ns);
+
+        // The servo follows the group, all devices share the trim
+        if (edge == PULSE_EDGE_START)
+            ctx.servo.add_second_start(minute * SECONDS_PER_MINUTE + devices[0].program.events[start_index].second,
+                                       ctx.scheduler.since_epoch_ns(effective_sum_ns / count));
+    }
+}
+
+static void log_fanout_stats(TransmitContext &ctx)
+{
+    ctx.log.log_skew({TX_SKEW_SPREAD, ctx.spread.count, ctx.spread.min_ns, ctx.spread.mean_ns(), ctx.spread.max_ns});
+    ctx.spread.reset();
+
+    for (FanoutDevice &device : *ctx.fanout)
+    {
+        const EdgeLatenessStats &skew = device.skew;
+        ctx.log.log_skew({static_cast<uint8_t>(device.dds->device()), skew.count, skew.min_ns, skew.mean_ns(),
+                          skew.max_ns});
+        device.skew.reset();
+    }
+}
+
+static void print_outage_totals(const TransmitContext &ctx)
+{
+    const OutageStats &stats = ctx.recovery->stats();
+
+    if (!stats.outage.count)
+        return;
+
+    std::cout << "Device outages: " << stats.outage.count << ", " << ctx.total_missed_edges << " edges missed, down "
+              << ns_to_ms(stats.outage.sum_ns) << " ms in total, outage min/avg/max " << ns_to_ms(stats.outage.min_ns)
+              << "/" << ns_to_ms(stats.outage.mean_ns()) << "/" << ns_to_ms(stats.outage.max_ns)
+              << " ms, reconnect min/avg/max " << ns_to_ms(stats.recovery.min_ns) << "/"
+              << ns_to_ms(stats.recovery.mean_ns()) << "/" << ns_to_ms(stats.recovery.max_ns) << " ms ("
+              << stats.attempts << " attempts)\n";
+}
+
+static void print_fanout_totals(const TransmitContext &ctx)
+{
+    const EdgeLatenessStats &spread = ctx.total_spread;
+
+    std::cout << "Fan-out over the whole run, edge spread min/avg/max " << ns_to_ms(spread.min_ns) << "/"
+              << ns_to_ms(spread.mean_ns()) << "/" << ns_to_ms(spread.max_ns) << " ms (" << spread.count << " edges)\n";
+
+    for (const FanoutDevice &device : *ctx.fanout)
+    {
+        const EdgeLatenessStats &skew = device.total_skew;
+        std::cout << "  device [" << device.dds->device() << "] frames " << std::showpos << device.offset_minutes
+                  << std::noshowpos << " min, skew min/avg/max " << ns_to_ms(skew.min_ns) << "/"
+                  << ns_to_ms(skew.mean_ns()) << "/" << ns_to_ms(skew.max_ns) << " ms (" << skew.count << " edges)\n";
+    }
+}
+
+// --fanout: the host timed engine on every device of the group from one
+// deadline schedule. Each device has its own worker and all of them get the
+// same deadlines, so the edges go out in parallel rather than one USB round
+// trip after another. Frames may be shifted per device.
+static void transmit_fanout(TransmitContext &ctx)
+{
+    EdgeScheduler &scheduler = ctx.scheduler;
+    std::vector<FanoutDevice> &devices = *ctx.fanout;
+
+    sleep_until_ns(scheduler.deadline_ns(0, 0) - static_cast<int64_t>(INITIAL_FRAME_START_MS) * NS_PER_MS);
+
+    // Start frame
+    for (FanoutDevice &device : devices)
+        device.dds->set_on_off(true);
+
+    // Same priority as the transmit thread but not its CPU pin, the workers have to
+    // run side by side. Memory is already locked process wide.
+    RtThreadConfig worker_rt = ctx.options.rt;
+    worker_rt.cpu_mask    = 0;
+    worker_rt.lock_memory = false;
+
+    std::vector<std::unique_ptr<DeviceWorker>> workers;
+    for (FanoutDevice &device : devices)
+    {
+        workers.emplace_back(new DeviceWorker(*device.dds));
+        workers.back()->start(worker_rt);
+    }
+
+    for (uint64_t minute = 0; keep_running(ctx, minute); ++minute)
+    {
+        scheduler.begin_minute();
+
+        const Dcf77Frame frame = frame_for_minute(ctx, minute);
+        const int64_t frame_utc_ns = dcf77_frame_utc_minute_ns(frame.bits);
+
+        for (FanoutDevice &device : devices)
+        {
+            const uint64_t bits = device.offset_minutes
+                                  ? dcf77_encode_frame(frame_utc_ns + device.offset_minutes * NS_PER_MINUTE)
+                                  : frame.bits;
+            compile_pulse_program(bits, PULSE_LEVELS, device.program);
+        }
+
+        const int64_t minute_ns = static_cast<int64_t>(minute * SECONDS_PER_MINUTE) * NS_PER_S;
+        int64_t trim_ns = 0;
+
+        // Every program has the same events in the same order, only the END offsets differ
+        const PulseProgram &layout = devices[0].program;
+
+        for (uint32_t i = 0; i < layout.count && !stop_requested(); ++i)
+        {
+            const PulseEvent &event = layout.events[i];
+
+            if (event.edge == PULSE_EDGE_MARKER)
+                continue;
+
+            if (event.edge == PULSE_EDGE_START)
+            {
+                scheduler.resync();
+                trim_ns = ctx.servo.trim_ns();
+            }
+
+            for (size_t d = 0; d < devices.size(); ++d)
+            {
+                FanoutDevice &device = devices[d];
+                const PulseEvent &device_event = device.program.events[i];
+
+                device.planned_ns[event.edge] = scheduler.epoch_deadline_ns(minute_ns + device_event.offset_ns);
+                device.queued[event.edge] = submit_edge(ctx, *workers[d], device_event, device.planned_ns[event.edge],
+                                                        trim_ns, device.seq[event.edge]);
+            }
+
+            if (event.edge == PULSE_EDGE_END)
+                complete_fanout_second(ctx, workers, minute, i - 1);
+        }
+
+        log_fanout_stats(ctx);
+        log_minute_stats(ctx);
+    }
+
+    for (std::unique_ptr<DeviceWorker> &worker : workers)
+        worker->stop();
+}
+
+// Carrier cycles in a reduction of the given width, 7750 for 100 ms at 77.5 kHz
+static WORD burst_cycles(int64_t width_ns)
+{
+    return static_cast<WORD>(std::llround(static_cast<double>(width_ns) * CARIER_FREQUENCY_HZ / NS_PER_S));
+}
+
+// Start a reduction as one DDS burst of exactly `cycles` carrier cycles at low
+// amplitude. Experimental: this assumes mode and amplitude writes latch at
+// burst boundaries, which only the simulator models and no hardware test has
+// confirmed. If it holds the continuous carrier keeps running until the
+// trigger and the writes queued during the burst resume it after the last
+// cycle: only the trigger is host timed, the width is counted by the DDS.
+// Returns the predicted burst start.
+static int64_t issue_burst(TransmitContext &ctx, const PulseEvent &event, int64_t planned_ns, int64_t trim_ns,
+                           WORD cycles)
+{
+    const int64_t width_ns = static_cast<int64_t>(std::llround(cycles * static_cast<double>(NS_PER_S) / CARIER_FREQUENCY_HZ));
+
+    // Arming only latches, do it early enough that slow calls never delay the trigger
+    sleep_until_ns(planned_ns + trim_ns - static_cast<int64_t>(BURST_ARM_LEAD_MS) * NS_PER_MS);
+
+    ctx.dds.set_cmd(DDS_CMD_BURST);
+    ctx.dds.set_amplitude(event.amplitude_mv);
+
+    const int64_t due_ns = planned_ns + trim_ns - ctx.sdk_latency.lead_ns();
+    ctx.scheduler.wait_until(due_ns);
+
+    int64_t call_ns = mono_now_ns();
+    const ULONG rc  = p_ddsEmitSingle(ctx.dev);
+    int64_t done_ns = mono_now_ns();
+
+    // A failed call's duration is a USB timeout, not a latency sample
+    if (rc == HT_OK)
+        ctx.sdk_latency.add(done_ns - call_ns);
+    ++ctx.direct_calls;
+
+    const int64_t start_ns = ctx.sdk_latency.effective_ns(call_ns, done_ns);
+
+    ctx.edge_error.add(start_ns - planned_ns);
+    ctx.total_edge_error.add(start_ns - planned_ns);
+    ctx.histograms.lateness.record(call_ns - due_ns);
+    ctx.histograms.sdk_call.record(done_ns - call_ns);
+    ctx.histograms.change_error.record(std::llabs(start_ns - planned_ns));
+    ctx.log.log_edge(event.second, event.bit_value, PULSE_EDGE_START, planned_ns, start_ns, rc);
+
+    // Queue the return to the full carrier while the burst plays. A write that
+    // lands after the last cycle stretches the reduction by the difference.
+    ctx.dds.set_cmd(DDS_CMD_CONTINUOUS);
+
+    call_ns = mono_now_ns();
+    const WORD restore_rc = device_command_execute(ctx.dds, DeviceCommandKind::SetAmplitude, AMPLITUDE_HIGH);
+    done_ns = mono_now_ns();
+
+    const int64_t burst_end_ns = start_ns + width_ns;
+    const int64_t end_ns       = std::max(burst_end_ns, ctx.sdk_latency.effective_ns(call_ns, done_ns));
+
+    ctx.pulse_width_error.add(end_ns - start_ns - (event.bit_value ? PULSE_LEVELS.bit_1_pulse_ns : PULSE_LEVELS.bit_0_pulse_ns));
+    ctx.log.log_edge(event.second, event.bit_value, PULSE_EDGE_END, burst_end_ns, end_ns, restore_rc);
+
+    return start_ns;
+}
+
+// Host timed starts, DDS counted widths. Same schedule and servo as
+// transmit_host_timed, the end events of the program are played by the burst.
+static void transmit_burst(TransmitContext &ctx)
+{
+    EdgeScheduler &scheduler = ctx.scheduler;
+
+    sleep_until_ns(scheduler.deadline_ns(0, 0) - static_cast<int64_t>(INITIAL_FRAME_START_MS) * NS_PER_MS);
 
-    std::cout << "Starting DCF77 modulation loop with date: " << dcf77_frame_to_string(TEST_DCF77_FRAME) << "... \n";
+    std::cout << "Burst mode is experimental: it assumes mode and amplitude writes latch at burst boundaries\n";
 
-    modulate_dcf77(dev, TEST_DCF77_FRAME);
+    const WORD bit_0_cycles = burst_cycles(PULSE_LEVELS.bit_0_pulse_ns);
+    std::cout << "ddsSDKSetBurstNum rc = " << ctx.dds.set_burst_cycles(bit_0_cycles) << " (" << bit_0_cycles
+              << " cycles)\n";
+
+    // Start frame
+    ctx.dds.set_cmd(DDS_CMD_CONTINUOUS);
+    ctx.dds.set_on_off(true);
+
+    for (uint64_t minute = 0; keep_running(ctx, minute); ++minute)
+    {
+        scheduler.begin_minute();
+
+        const Dcf77Frame frame = frame_for_minute(ctx, minute);
+        compile_pulse_program(frame.bits, PULSE_LEVELS, ctx.program);
+
+        const int64_t minute_ns = static_cast<int64_t>(minute * SECONDS_PER_MINUTE) * NS_PER_S;
+
+        for (uint32_t i = 0; i < ctx.program.count && !stop_requested(); ++i)
+        {
+            const PulseEvent &event = ctx.program.events[i];
+
+            if (event.edge != PULSE_EDGE_START)
+                continue;
+
+            // Set during the full carrier, the cache skips it between bits of equal value
+            const WORD cycles = burst_cycles(event.bit_value ? PULSE_LEVELS.bit_1_pulse_ns : PULSE_LEVELS.bit_0_pulse_ns);
+            ctx.dds.set_burst_cycles(cycles);
+
+            scheduler.resync();
+
+            const int64_t start_ns = issue_burst(ctx, event, scheduler.epoch_deadline_ns(minute_ns + event.offset_ns),
+                                                 ctx.servo.trim_ns(), cycles);
+
+            ctx.servo.add_second_start(minute * SECONDS_PER_MINUTE + event.second, scheduler.since_epoch_ns(start_ns));
+        }
+
+        log_minute_stats(ctx);
+    }
+}
+
+// Configure carrier, amplitude and AM depth in one ddsSetFAOC call, then let
+// the host timed loop switch only between the plain and the modulated carrier.
+// Unverified: a 0 Hz modulator has no defined phase, so the AM output may hold
+// any envelope level between AMPLITUDE_LOW and AMPLITUDE_HIGH, not necessarily
+// the trough, AMPLITUDE_HIGH * (1 - depth) = AMPLITUDE_LOW, that this assumes.
+static void transmit_am(TransmitContext &ctx)
+{
+    WORD rc = ctx.dds.set_faoc(ctx.options.carrier_hz, AMPLITUDE_HIGH, 0, AM_DEPTH);
+    std::cout << "ddsSetFAOC rc = " << rc << " (AM depth " << AM_DEPTH << ")\n";
+
+    ULONG freq_rc = ctx.dds.set_am_frequency(AM_MODULATION_HZ);
+    std::cout << "ddsSetAMFMFreq rc = " << freq_rc << "\n";
+
+    rc = ctx.dds.set_wave_type(WAVE_SINE);
+    std::cout << "ddsSDKSetWaveType rc = " << rc << "\n";
+
+    transmit_host_timed(ctx);
+
+    ctx.dds.set_wave_type(WAVE_SINE);
+}
+
+// Both the generator outputs of a fan-out group or the single one
+static void set_outputs_on_off(TransmitContext &ctx, bool on)
+{
+    if (!ctx.fanout)
+    {
+        ctx.dds.set_on_off(on);
+        return;
+    }
+
+    for (FanoutDevice &device : *ctx.fanout)
+        device.dds->set_on_off(on);
+}
+
+// Runs until a stop is requested or --minutes have been sent, then leaves the generator output off.
+// With a fan-out group dds is its first device.
+static TransmitSummary modulate_dcf77(DdsStateCache &dds, uint64_t dcf_frame, const TransmitOptions &options,
+                                      std::vector<FanoutDevice> *fanout = nullptr)
+{
+    const int64_t preamble_ns = static_cast<int64_t>(INITIAL_ERROR_TIME_MS + INITIAL_FRAME_START_MS) * NS_PER_MS;
+
+    // Every edge is an absolute deadline relative to the first bit of the first frame
+    EdgeScheduler scheduler(mono_now_ns() + preamble_ns);
+
+    // Move the first bit onto the first UTC minute boundary that still leaves room for the preamble
+    int64_t utc_start_ns = 0;
+    if (options.utc_aligned)
+    {
+        utc_start_ns = next_utc_minute_ns(utc_now_ns() + preamble_ns);
+        scheduler.lock_to_utc(utc_start_ns);
+    }
+
+    // The frame sent during a minute announces the time at its closing minute marker
+    FrameDoubleBuffer frames;
+    FrameEncoder encoder(frames);
+
+    if (options.live_frames)
+        encoder.start(utc_start_ns + NS_PER_MINUTE);
+    else
+        frames.publish({0, dcf_frame});
+
+    std::unique_ptr<EdgeTimingHistograms> histograms(new EdgeTimingHistograms());
+
+    // Console output is formatted off the timing thread
+    std::unique_ptr<TxTraceWriter> trace(options.tx_trace ? new TxTraceWriter(options.tx_trace) : nullptr);
+
+    TxLogger log;
+    log.start(scheduler.epoch_ns(), histograms.get(), trace.get());
+
+    SdkLatencyEstimator sdk_latency(options.sdk_latency);
+    PeriodServo servo(options.servo);
+
+    TransmitContext ctx = {dds.device(), dds, options, scheduler, frames, utc_start_ns, log, *histograms,
+                           sdk_latency, servo, {}, {}, {}, {}, 0, fanout, {}, {}, nullptr, 0, 0};
+
+    // Only the host timed engine hands the device over, inline or through its
+    // worker. Burst and AM keep state a reconnect would lose, a fan-out group
+    // spreads over several devices.
+    std::unique_ptr<DeviceRecovery> recovery;
+    if (options.reconnect && options.engine == TransmitEngine::HostTimed && !fanout)
+    {
+        const RecoveryCalls calls = {p_dsoHTDeviceConnect, p_dsoInitHard};
+        const DdsSetup setup      = {WAVE_SINE, options.carrier_hz, AMPLITUDE_HIGH, 0};
+
+        recovery.reset(new DeviceRecovery(dds, calls, setup, options.recovery));
+        ctx.recovery = recovery.get();
+    }
+
+    // Elevate only now, the encoder, logger and recovery threads must not inherit SCHED_FIFO
+    const RtThreadSaved saved_rt = rt_save_current_thread();
+    rt_configure_current_thread(options.rt);
+
+    // Initial idle: generator OFF for at least 3 s - force receiver to enter error state
+    set_outputs_on_off(ctx, false);
+
+    const uint64_t issued = dds.stats().issued;
+
+    switch (fanout ? TransmitEngine::HostTimed : options.engine)
+    {
+    case TransmitEngine::Burst: transmit_burst(ctx); break;
+    case TransmitEngine::Am:    transmit_am(ctx); break;
+    case TransmitEngine::HostTimed:
+        if (fanout)
+            transmit_fanout(ctx);
+        else
+            transmit_host_timed(ctx);
+        break;
+    }
+
+    if (device_lost(ctx))
+        std::cout << "Device did not come back within " << ns_to_ms(options.recovery.give_up_ns) / 1000.0
+                  << " s, transmission stopped\n";
+
+    // The device is this thread's again, even if a reconnect was under way
+    if (recovery)
+        recovery->stop();
+
+    // --bench-engines starts the next run's threads from here
+    rt_restore_current_thread(saved_rt);
+
+    const uint64_t edge_calls = dds.stats().issued - issued + ctx.direct_calls;
+
+    set_outputs_on_off(ctx, false);
+
+    encoder.stop();
+    log.stop();
+    log.print_totals();
+
+    if (trace)
+    {
+        trace->close();
+
+        const TxTraceStats &stats = trace->stats();
+        std::cout << "Transmit trace: " << stats.records << " records appended to " << trace->path() << " ("
+                  << stats.files << " files), " << stats.dropped << " dropped\n";
+    }
+
+    if (fanout)
+        print_fanout_totals(ctx);
+
+    if (recovery)
+        print_outage_totals(ctx);
+
+    TransmitSummary summary = {ctx.total_edge_error, {}, {}, {}, edge_calls};
+
+    std::unique_ptr<LatencyHistogram::Snapshot> snapshot(new LatencyHistogram::Snapshot());
+    histograms->lateness.snapshot(*snapshot);
+    summary.lateness = latency_percentiles(*snapshot);
+    histograms->sdk_call.snapshot(*snapshot);
+    summary.sdk_call = latency_percentiles(*snapshot);
+    histograms->change_error.snapshot(*snapshot);
+    summary.change_error = latency_percentiles(*snapshot);
+
+    return summary;
+}
+
+// Same frames on every engine in turn, --minutes each, then one line per engine
+static void bench_engines(DdsStateCache &dds, uint64_t dcf_frame, const TransmitOptions &options)
+{
+    const TransmitEngine engines[] = {TransmitEngine::HostTimed, TransmitEngine::Am, TransmitEngine::Burst};
+    TransmitSummary summaries[3];
+
+    size_t runs = 0;
+    for (; runs < 3 && !stop_requested(); ++runs)
+    {
+        TransmitOptions run_options = options;
+        run_options.engine  = engines[runs];
+
+        if (!engine_supported(options, run_options.engine))
+        {
+            std::cout << "Skipping " << engine_name(run_options.engine) << " engine, the SDK lacks its calls\n";
+            summaries[runs] = TransmitSummary();
+            continue;
+        }
+
+        run_options.minutes = options.minutes ? options.minutes : BENCH_DEFAULT_MINUTES;
+
+        std::cout << "Benchmarking " << engine_name(run_options.engine) << " engine for " << run_options.minutes
+                  << " minutes\n";
+        summaries[runs] = modulate_dcf77(dds, dcf_frame, run_options);
+
+        // Decode each engine's output on its own
+        if (options.simulated)
+        {
+            sim_print_summary(PULSE_LEVELS);
+            sim_configure(options.sim);
+        }
+    }
+
+    std::cout << "Engine comparison (amplitude change error min/avg/max, |change error| p99, lateness p50/p99/max, SDK call p50/p99, calls per edge):\n";
+    for (size_t i = 0; i < runs; ++i)
+    {
+        const TransmitSummary &summary = summaries[i];
+        const uint64_t edges = summary.edge_error.count;
+
+        if (!edges)
+        {
+            std::cout << "  " << engine_name(engines[i]) << ": no edges sent\n";
+            continue;
+        }
+
+        std::cout << "  " << engine_name(engines[i]) << ": "
+                  << ns_to_ms(summary.edge_error.min_ns) << "/" << ns_to_ms(summary.edge_error.mean_ns()) << "/"
+                  << ns_to_ms(summary.edge_error.max_ns) << " ms, "
+                  << ns_to_ms(summary.change_error.p99_ns) << " ms, "
+                  << ns_to_ms(summary.lateness.p50_ns) << "/" << ns_to_ms(summary.lateness.p99_ns) << "/"
+                  << ns_to_ms(summary.lateness.max_ns) << " ms, "
+                  << ns_to_ms(summary.sdk_call.p50_ns) << "/" << ns_to_ms(summary.sdk_call.p99_ns) << " ms, "
+                  << (edges ? static_cast<double>(summary.edge_calls) / edges : 0.0) << " (" << edges << " edges)\n";
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// "all", or slots with an optional frame shift in minutes: "0,1:60,2:-1"
+static bool parse_fanout(const char *text, TransmitOptions &options)
+{
+    if (std::strcmp(text, "all") == 0)
+    {
+        options.fanout_all = true;
+        return true;
+    }
+
+    uint32_t seen = 0;
+    options.fanout_count = 0;
+
+    while (*text)
+    {
+        char *end = nullptr;
+        const long slot = std::strtol(text, &end, 10);
+        if (end == text || slot < 0 || slot >= DEVICE_SLOTS || (seen & (1u << slot)))
+            return false;
+
+        long minutes = 0;
+        if (*end == ':')
+        {
+            text    = end + 1;
+            minutes = std::strtol(text, &end, 10);
+            if (end == text)
+                return false;
+        }
+
+        seen |= 1u << slot;
+        options.fanout[options.fanout_count++] = {static_cast<WORD>(slot), static_cast<int32_t>(minutes)};
+
+        if (*end == ',')
+            ++end;
+        else if (*end)
+            return false;
+        text = end;
+    }
+
+    return options.fanout_count > 0;
+}
+
+static bool parse_options(int argc, char **argv, TransmitOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--utc") == 0)
+        {
+            options.utc_aligned = true;
+        }
+        else if (std::strcmp(argv[i], "--burst") == 0)
+        {
+            options.engine = TransmitEngine::Burst;
+        }
+        else if (std::strcmp(argv[i], "--am") == 0)
+        {
+            options.engine = TransmitEngine::Am;
+        }
+        else if (std::strcmp(argv[i], "--bench-engines") == 0)
+        {
+            options.bench_engines = true;
+        }
+        else if (std::strcmp(argv[i], "--calibrate") == 0)
+        {
+            options.calibrate = true;
+        }
+        else if (std::strcmp(argv[i], "--no-cal") == 0)
+        {
+            options.use_calibration = false;
+        }
+        else if (std::strcmp(argv[i], "--worker") == 0)
+        {
+            options.device_worker = true;
+        }
+        else if (std::strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+        {
+            options.device = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--trace-sdk") == 0 && i + 1 < argc)
+        {
+            options.sdk_trace = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--tx-trace") == 0 && i + 1 < argc)
+        {
+            options.tx_trace = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--no-reconnect") == 0)
+        {
+            options.reconnect = false;
+        }
+        else if (std::strcmp(argv[i], "--reconnect-timeout") == 0 && i + 1 < argc)
+        {
+            options.recovery.give_up_ns = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * NS_PER_S);
+        }
+        else if (std::strcmp(argv[i], "--fanout") == 0 && i + 1 < argc)
+        {
+            if (!parse_fanout(argv[++i], options))
+            {
+                std::cerr << "--fanout takes all or <slot>[:<minutes>],... with distinct slots\n";
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[i], "--minutes") == 0 && i + 1 < argc)
+        {
+            options.minutes = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--live") == 0)
+        {
+            options.utc_aligned = true;
+            options.live_frames = true;
+        }
+        else if (std::strcmp(argv[i], "--sim") == 0)
+        {
+            options.simulated = true;
+        }
+        else if (std::strcmp(argv[i], "--sim-latency") == 0 && i + 1 < argc)
+        {
+            char *end = nullptr;
+            options.sim.latency_min_ns = static_cast<int64_t>(std::strtod(argv[++i], &end) * NS_PER_MS);
+            options.sim.latency_max_ns = (*end == ':') ? static_cast<int64_t>(std::strtod(end + 1, nullptr) * NS_PER_MS)
+                                                       : options.sim.latency_min_ns;
+        }
+        else if (std::strcmp(argv[i], "--sim-devices") == 0 && i + 1 < argc)
+        {
+            options.sim.devices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--sim-disconnect") == 0 && i + 1 < argc)
+        {
+            char *end = nullptr;
+            options.sim.disconnect_at_ns = static_cast<int64_t>(std::strtod(argv[++i], &end) * NS_PER_S);
+            options.sim.disconnect_ns    = (*end == ':') ? static_cast<int64_t>(std::strtod(end + 1, nullptr) * NS_PER_S)
+                                                         : 0;
+        }
+        else if (std::strcmp(argv[i], "--no-rt") == 0)
+        {
+            options.rt.elevate = false;
+        }
+        else if (std::strcmp(argv[i], "--no-mlock") == 0)
+        {
+            options.rt.lock_memory = false;
+        }
+        else if (std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc)
+        {
+            options.rt.cpu_mask = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (std::strcmp(argv[i], "--no-servo") == 0)
+        {
+            options.servo.enabled = false;
+        }
+        else if (std::strcmp(argv[i], "--no-latency-comp") == 0)
+        {
+            options.sdk_latency.enabled = false;
+        }
+        else if (std::strcmp(argv[i], "--latency-gain") == 0 && i + 1 < argc)
+        {
+            options.sdk_latency.gain = std::strtod(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--latency-point") == 0 && i + 1 < argc)
+        {
+            options.sdk_latency.effect_point = std::strtod(argv[++i], nullptr);
+        }
+        else if (std::strcmp(argv[i], "--latency-max-ms") == 0 && i + 1 < argc)
+        {
+            options.sdk_latency.max_lead_ns = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * NS_PER_MS);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << argv[i] << "\n"
+                      << "Usage: " << argv[0] << " [--utc] [--live] [--burst] [--am]"
+                      << " [--minutes <n>] [--bench-engines] [--calibrate] [--no-cal] [--worker]"
+                      << " [--device <slot>] [--fanout all|<slot>[:<minutes>],...] [--no-reconnect] [--reconnect-timeout <s>]"
+                      << " [--trace-sdk <file>] [--tx-trace <dir>]"
+                      << " [--sim] [--sim-latency <min_ms>:<max_ms>] [--sim-devices <n>] [--sim-disconnect <at_s>:<for_s>]"
+                      << " [--no-rt] [--no-mlock] [--cpu <mask>]"
+                      << " [--no-servo] [--no-latency-comp]"
+                      << " [--latency-gain <0..1>] [--latency-point <0..1>] [--latency-max-ms <ms>]\n";
+            return false;
+        }
+    }
+
+    const SdkLatencyTuning &tuning = options.sdk_latency;
+    if (tuning.gain <= 0.0 || tuning.gain > 1.0 || tuning.effect_point < 0.0 || tuning.effect_point > 1.0
+        || tuning.max_lead_ns < 0)
+    {
+        std::cerr << "Latency compensation parameters out of range\n";
+        return false;
+    }
+
+    if ((options.fanout_all || options.fanout_count)
+        && (options.bench_engines || options.engine != TransmitEngine::HostTimed || options.device >= 0))
+    {
+        std::cerr << "--fanout drives the host timed engine only and replaces --device\n";
+        return false;
+    }
+
+    if (options.reconnect && (options.fanout_all || options.fanout_count || options.bench_engines
+                              || options.engine != TransmitEngine::HostTimed))
+        std::cerr << "Note: a lost device is reconnected by the host timed engine on a single device only"
+                  << (options.bench_engines ? ", not in the other bench runs" : ", not in this run")
+                  << " (--no-reconnect silences this)\n";
+
+    if (options.device >= static_cast<int>(DEVICE_SLOTS) || options.sim.devices > DEVICE_SLOTS)
+    {
+        std::cerr << "Device slots are 0.." << DEVICE_SLOTS - 1 << "\n";
+        return false;
+    }
+
+    if (options.sim.latency_min_ns < 0 || options.sim.latency_max_ns < options.sim.latency_min_ns)
+    {
+        std::cerr << "Simulated latency range out of order\n";
+        return false;
+    }
+
+    if (options.recovery.give_up_ns <= 0 || options.sim.disconnect_at_ns < 0 || options.sim.disconnect_ns < 0)
+    {
+        std::cerr << "Reconnect timeout and simulated disconnect must be positive\n";
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+// Picks the DDS carrier setting: measured with --calibrate, else the cached one
+// for this serial, else nominal. Fails only if a requested calibration fails.
+static bool calibrate_carrier(DdsStateCache &dds, const char *serial, TransmitOptions &options)
+{
+    CarrierCalibration calibration;
+
+    if (options.calibrate && !sdk_supports(options, {SdkExport::dsoHTSetHardFC, SdkExport::dsoHTGetHardFC}))
+    {
+        std::cerr << "The SDK has no frequency counter calls, cannot calibrate\n";
+        return false;
+    }
+
+    if (options.calibrate)
+    {
+        std::cout << "Calibrating carrier, wire the generator output to the frequency counter input\n";
+
+        const HardFcCalls calls = {p_dsoHTSetHardFC, p_dsoHTGetHardFC};
+
+        dds.set_on_off(true);
+        const bool ok = carrier_calibrate(dds, calls, CARIER_FREQUENCY_HZ, CarrierCalTuning(), calibration);
+        dds.set_on_off(false);
+
+        if (!ok)
+        {
+            std::cerr << "Carrier calibration failed\n";
+            return false;
+        }
+
+        if (!carrier_cal_store(CARRIER_CAL_FILE, serial, CARIER_FREQUENCY_HZ, calibration))
+            std::cerr << "Cannot write " << CARRIER_CAL_FILE << "\n";
+    }
+    else if (!options.use_calibration || !carrier_cal_load(CARRIER_CAL_FILE, serial, CARIER_FREQUENCY_HZ, calibration))
+    {
+        std::cout << "No carrier calibration for this device, using the nominal setting\n";
+        return true;
+    }
+
+    options.carrier_hz = calibration.setting_hz;
+    const float achieved_hz = dds.set_frequency(options.carrier_hz);
+
+    std::cout << "Carrier setting " << (static_cast<double>(options.carrier_hz) / CARIER_FREQUENCY_HZ - 1.0) * 1e6
+              << " ppm from nominal (DDS achieved " << (static_cast<double>(achieved_hz) / CARIER_FREQUENCY_HZ - 1.0) * 1e6
+              << " ppm), " << calibration.error_ppm << " ppm error after calibration\n";
+    return true;
+}
+
+// The devices to transmit on: the --fanout group, else the --device slot or the
+// first one found. Returns how many, 0 after printing why there are none.
+static uint32_t select_devices(const DeviceInventory &inventory, const TransmitOptions &options,
+                               FanoutMember (&members)[DEVICE_SLOTS])
+{
+    if (options.fanout_all)
+    {
+        for (uint32_t i = 0; i < inventory.count; ++i)
+            members[i] = {inventory.devices[i].index, 0};
+        return inventory.count;
+    }
+
+    if (options.fanout_count)
+    {
+        for (uint32_t i = 0; i < options.fanout_count; ++i)
+        {
+            members[i] = options.fanout[i];
+            if (!inventory_find(inventory, members[i].slot))
+            {
+                std::cerr << "No device in slot " << members[i].slot << "\n";
+                return 0;
+            }
+        }
+        return options.fanout_count;
+    }
+
+    const DeviceInfo *device = options.device < 0 ? &inventory.devices[0]
+                                                  : inventory_find(inventory, static_cast<WORD>(options.device));
+    if (!device)
+    {
+        std::cerr << "No device in slot " << options.device << "\n";
+        return 0;
+    }
+
+    members[0] = {device->index, 0};
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    std::cout << "Hantek DCF77 generator\n";
+
+    TransmitOptions options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
+    install_stop_handler();
+
+    int64_t phase_start_ns = mono_now_ns();
+    if (!load_sdk(options))
+        return 1;
+    const int64_t load_ns = mono_now_ns() - phase_start_ns;
+
+    const DiscoveryCalls discovery_calls = {p_dsoHTSearchDevice, p_dsoHTDeviceConnect, p_dsoGetDeviceName,
+                                            p_dsoGetDeviceSN, p_dsoGetFPGAVersion};
+
+    std::unique_ptr<DeviceInventory> inventory(new DeviceInventory());
+    if (!discover_devices(discovery_calls, *inventory))
+    {
+        std::cerr << "Device search failed\n";
+        unload_sdk();
+        return 1;
+    }
+
+    inventory_print(*inventory);
+    if (inventory->count == 0)
+    {
+        unload_sdk();
+        return 0;
+    }
+
+    FanoutMember members[DEVICE_SLOTS];
+    const uint32_t member_count = select_devices(*inventory, options, members);
+    if (!member_count)
+    {
+        unload_sdk();
+        return 1;
+    }
+
+    // Every DDS write of the transmitter goes through the cache, redundant ones never reach USB
+    const DdsCalls dds_calls = {p_ddsSDKSetWaveType, p_ddsSDKSetFre, p_ddsSDKSetAmp, p_ddsSDKSetOffset,
+                                p_ddsSetOnOff, p_ddsSetCmd, p_ddsSDKSetBurstNum, p_ddsSetFAOC,
+                                p_ddsSetAMFMFreq};
+    std::vector<std::unique_ptr<DdsStateCache>> caches;
+
+    int64_t init_ns = 0;
+    int64_t dds_ns  = 0;
+
+    for (uint32_t m = 0; m < member_count; ++m)
+    {
+        const DeviceInfo &info = *inventory_find(*inventory, members[m].slot);
+        std::cout << "Using device [" << info.index << "] serial " << info.serial << "\n";
+
+        phase_start_ns = mono_now_ns();
+        const WORD rc = p_dsoInitHard(info.index);
+        init_ns += mono_now_ns() - phase_start_ns;
+
+        std::cout << "dsoInitHard rc = " << rc << "\n";
+        if (rc != HT_OK)
+        {
+            std::cerr << "InitHard fail rc=" << rc << "\n";
+            unload_sdk();
+            return 1;
+        }
+
+        caches.emplace_back(new DdsStateCache(info.index, dds_calls));
+        DdsStateCache &cache = *caches.back();
+
+        phase_start_ns = mono_now_ns();
+
+        cache.stage_wave_type(WAVE_SINE);
+        cache.stage_frequency(CARIER_FREQUENCY_HZ);     // 77.5 kHz
+        cache.stage_amplitude(AMPLITUDE_HIGH);
+        cache.stage_offset(0);
+        std::cout << "DDS configured with " << cache.commit() << " SDK calls\n";
+
+        dds_ns += mono_now_ns() - phase_start_ns;
+    }
+
+    const DiscoveryTiming &discovery = inventory->timing;
+    std::cout << "Startup: SDK load " << ns_to_ms(load_ns) << " ms, search " << ns_to_ms(discovery.search_ns)
+              << " ms, probe " << ns_to_ms(discovery.probe_ns) << " ms, init " << ns_to_ms(init_ns) << " ms, DDS setup "
+              << ns_to_ms(dds_ns) << " ms\n";
+
+    // Each device keeps its own carrier setting, the engines read the first one's from options
+    for (uint32_t m = 0; m < member_count; ++m)
+    {
+        TransmitOptions device_options = options;
+        const DeviceInfo &info = *inventory_find(*inventory, members[m].slot);
+
+        if (!calibrate_carrier(*caches[m], info.serial, m == 0 ? options : device_options))
+        {
+            unload_sdk();
+            return 1;
+        }
+    }
+
+    DdsStateCache &dds = *caches[0];
+
+    std::vector<FanoutDevice> fanout(options.fanout_all || options.fanout_count ? member_count : 0);
+    for (uint32_t m = 0; m < fanout.size(); ++m)
+    {
+        fanout[m].dds            = caches[m].get();
+        fanout[m].offset_minutes = members[m].offset_minutes;
+    }
+
+    if (!options.bench_engines && !engine_supported(options, options.engine))
+    {
+        std::cerr << "The SDK lacks the calls of the " << engine_name(options.engine)
+                  << " engine, falling back to host timed\n";
+        options.engine = TransmitEngine::HostTimed;
+    }
+
+    if (!options.simulated)
+        print_sdk_load_stats();
+
+    std::cout << "Ctrl-C to stop\n"; 
+
+    if (options.live_frames)
+        std::cout << "Starting DCF77 modulation loop with live system time... \n";
+    else
+        std::cout << "Starting DCF77 modulation loop with date: " << dcf77_frame_to_string(TEST_DCF77_FRAME) << "... \n";
+
+    // The transmit loop runs on its own elevated thread, main only waits for Ctrl-C
+    std::atomic<bool> finished{false};
+    std::thread transmitter([&]()
+    {
+        if (options.bench_engines)
+            bench_engines(dds, TEST_DCF77_FRAME, options);
+        else
+            modulate_dcf77(dds, TEST_DCF77_FRAME, options, fanout.empty() ? nullptr : &fanout);
+        finished = true;
+    });
+
+    while (!stop_requested() && !finished)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    transmitter.join();
+
+    for (const std::unique_ptr<DdsStateCache> &cache : caches)
+    {
+        const DdsCacheStats &stats = cache->stats();
+        std::cout << "DDS state cache [" << cache->device() << "]: " << stats.issued << " calls sent, "
+                  << stats.redundant << " redundant and " << stats.coalesced << " coalesced writes saved\n";
+
+        if (options.simulated && !options.bench_engines)
+            sim_print_summary(PULSE_LEVELS, cache->device());
+    }
 
-    // We never reach this point because of the infinite loop above.
-    FreeLibrary(hHard);
+    unload_sdk();
     return 0; 
 }
@@ -0,0 +1,157 @@
+#include "carrier_cal.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+// The counter is read a little after its gate closed
+const int64_t HARD_FC_READ_MARGIN_NS = 50 * NS_PER_MS;
+
+static double ppm(double measured_hz, double nominal_hz)
+{
+    return (measured_hz - nominal_hz) / nominal_hz * 1e6;
+}
+
+double carrier_measure_hz(WORD dev, const HardFcCalls &calls, int64_t gate_ns)
+{
+    if (!calls.set(dev, static_cast<ULONG>(gate_ns), 1))
+        return 0.0;
+
+    sleep_until_ns(mono_now_ns() + gate_ns + HARD_FC_READ_MARGIN_NS);
+
+    ULONG indata = 0;
+    ULONG count  = 0;
+    if (!calls.get(dev, &indata, &count))
+        return 0.0;
+
+    return static_cast<double>(indata) * NS_PER_S / (8.0 * static_cast<double>(gate_ns));
+}
+
+bool carrier_calibrate(DdsStateCache &dds, const HardFcCalls &calls, float nominal_hz,
+                       const CarrierCalTuning &tuning, CarrierCalibration &result)
+{
+    const double resolution_hz = NS_PER_S / (8.0 * static_cast<double>(tuning.gate_ns));
+
+    float setting_hz = nominal_hz;
+    result = {nominal_hz, HUGE_VAL};
+
+    for (uint32_t step = 0; step < tuning.max_iterations; ++step)
+    {
+        // The DDS rounds the setting to its tuning step, the counter measures what it achieved
+        const float achieved_hz = dds.set_frequency(setting_hz);
+        const double dds_hz     = achieved_hz > 0.0f ? achieved_hz : setting_hz;
+
+        const double measured_hz = carrier_measure_hz(dds.device(), calls, tuning.gate_ns);
+        if (measured_hz <= 0.0)
+        {
+            std::cerr << "Frequency counter read failed, is the generator output wired to it?\n";
+            break;
+        }
+
+        const double error_ppm = ppm(measured_hz, nominal_hz);
+        std::cout << "Carrier calibration step " << step << ": setting " << ppm(setting_hz, nominal_hz)
+                  << " ppm from nominal, DDS achieved " << ppm(dds_hz, nominal_hz) << " ppm, measured error "
+                  << error_ppm << " ppm\n";
+
+        if (std::fabs(error_ppm) < std::fabs(result.error_ppm))
+            result = {setting_hz, error_ppm};
+
+        if (std::fabs(measured_hz - nominal_hz) <= resolution_hz)
+            break;
+
+        // Scale what the DDS really produced, not the request it rounded
+        setting_hz = static_cast<float>(dds_hz * (nominal_hz / measured_hz));
+    }
+
+    if (result.error_ppm == HUGE_VAL)
+        return false;
+
+    dds.set_frequency(result.setting_hz);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+static bool parse_line(const char *line, std::string &serial, float &nominal_hz, CarrierCalibration &calibration)
+{
+    char text[DEVICE_SN_MAX];
+    double nominal = 0.0;
+    double setting = 0.0;
+    double error   = 0.0;
+
+    if (std::sscanf(line, "%63s %lf %lf %lf", text, &nominal, &setting, &error) != 4)
+        return false;
+
+    serial      = text;
+    nominal_hz  = static_cast<float>(nominal);
+    calibration = {static_cast<float>(setting), error};
+    return true;
+}
+
+bool carrier_cal_load(const char *path, const char *serial, float nominal_hz, CarrierCalibration &calibration)
+{
+    std::FILE *file = std::fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[256];
+    bool found = false;
+
+    while (!found && std::fgets(line, sizeof(line), file))
+    {
+        std::string line_serial;
+        float line_nominal_hz = 0.0f;
+        CarrierCalibration line_calibration;
+
+        found = parse_line(line, line_serial, line_nominal_hz, line_calibration) && line_serial == serial
+                && line_nominal_hz == nominal_hz;
+        if (found)
+            calibration = line_calibration;
+    }
+
+    std::fclose(file);
+    return found;
+}
+
+bool carrier_cal_store(const char *path, const char *serial, float nominal_hz, const CarrierCalibration &calibration)
+{
+    // Keep the other devices' lines, replace this one
+    std::vector<std::string> lines;
+
+    if (std::FILE *file = std::fopen(path, "r"))
+    {
+        char line[256];
+        while (std::fgets(line, sizeof(line), file))
+        {
+            std::string line_serial;
+            float line_nominal_hz = 0.0f;
+            CarrierCalibration line_calibration;
+
+            if (parse_line(line, line_serial, line_nominal_hz, line_calibration) && line_serial != serial)
+                lines.push_back(line);
+        }
+        std::fclose(file);
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%s %.3f %.6f %.4f\n", serial, nominal_hz, calibration.setting_hz,
+                  calibration.error_ppm);
+    lines.push_back(line);
+
+    std::FILE *file = std::fopen(path, "w");
+    if (!file)
+        return false;
+
+    bool ok = true;
+    for (const std::string &text : lines)
+        ok = ok && std::fputs(text.c_str(), file) >= 0;
+
+    return std::fclose(file) == 0 && ok;
+}
@@ -0,0 +1,50 @@
+#ifndef CARRIER_CAL_H
+#define CARRIER_CAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dds_state.h"
+#include "hantek_sdk.h"
+
+//------------------------------------------------------------------------------
+
+const char   CARRIER_CAL_FILE[]     = "carrier_calibration.txt";
+
+struct CarrierCalTuning
+{
+    int64_t  gate_ns        = 1000000000;   // counter gate, the manual recommends 0.1 - 1 s
+    uint32_t max_iterations = 6;
+};
+
+// DDS setting that produced the nominal carrier on one device
+struct CarrierCalibration
+{
+    float  setting_hz;
+    double error_ppm;   // measured at that setting
+};
+
+struct HardFcCalls
+{
+    PFN_dsoHTSetHardFC set;
+    PFN_dsoHTGetHardFC get;
+};
+
+//------------------------------------------------------------------------------
+
+// Count the scope's frequency counter input over one gate. The counter value
+// goes through the manual's frequency = nIndata * 1e9 / (8 * nTime).
+// Returns 0 if the counter could not be started or read.
+double carrier_measure_hz(WORD dev, const HardFcCalls &calls, int64_t gate_ns);
+
+// With the generator output wired to the counter input: measure, scale the
+// frequency ddsSDKSetFre reports as achieved by nominal / measured and repeat
+// until the carrier is within one count of nominal. The best setting is left on the device and returned.
+bool carrier_calibrate(DdsStateCache &dds, const HardFcCalls &calls, float nominal_hz,
+                       const CarrierCalTuning &tuning, CarrierCalibration &result);
+
+// Text cache, one "<serial> <nominal_hz> <setting_hz> <error_ppm>" line per device
+bool carrier_cal_load(const char *path, const char *serial, float nominal_hz, CarrierCalibration &calibration);
+bool carrier_cal_store(const char *path, const char *serial, float nominal_hz, const CarrierCalibration &calibration);
+
+#endif // CARRIER_CAL_H
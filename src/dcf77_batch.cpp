@@ -0,0 +1,185 @@
+#include "dcf77_batch.h"
+
+#include <thread>
+#include <vector>
+
+#include "dcf77_encoder.h"
+#include "dcf77_frame.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+const int64_t MINUTES_PER_HOUR = 60;
+
+// Minute field and P1 of every minute, in frame word layout
+struct MinuteTable
+{
+    uint64_t bits[MINUTES_PER_HOUR];
+
+    constexpr MinuteTable()
+        : bits()
+    {
+        for (unsigned minute = 0; minute < MINUTES_PER_HOUR; ++minute)
+        {
+            uint64_t air = Dcf77Minute::put(0, minute);
+            air = Dcf77MinuteParityBit::put(air, !Dcf77MinuteParity::even(air));
+            bits[minute] = dcf77_from_air_order(air);
+        }
+    }
+};
+
+static constexpr MinuteTable MINUTE_TABLE;
+
+static_assert(MINUTE_TABLE.bits[0] == 0, "minute 0 adds no bits to the hour base");
+static_assert(dcf77_parity_ok(MINUTE_TABLE.bits[59]), "minute table parity");
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// Walk the range hour by hour, calling fn(base, first_minute, minutes, offset)
+template <typename Fn>
+static void for_each_hour(int64_t first_utc_minute_ns, uint64_t count, Fn fn)
+{
+    int64_t  minute = floor_div(first_utc_minute_ns, NS_PER_MINUTE);
+    uint64_t done   = 0;
+
+    while (done < count)
+    {
+        const int64_t  hour        = floor_div(minute, MINUTES_PER_HOUR);
+        const unsigned into_hour   = static_cast<unsigned>(minute - hour * MINUTES_PER_HOUR);
+        const uint64_t left        = count - done;
+        const uint64_t in_this     = MINUTES_PER_HOUR - into_hour;
+        const unsigned minutes     = static_cast<unsigned>(left < in_this ? left : in_this);
+
+        // Minute 0 of the hour has no minute bits, so its frame is the hour base
+        const uint64_t base = dcf77_encode_frame(hour * MINUTES_PER_HOUR * NS_PER_MINUTE);
+
+        fn(base, into_hour, minutes, done);
+
+        done   += minutes;
+        minute += minutes;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void dcf77_encode_range(int64_t first_utc_minute_ns, uint64_t count, uint64_t *frames)
+{
+    for_each_hour(first_utc_minute_ns, count, [frames](uint64_t base, unsigned first, unsigned minutes, uint64_t offset)
+    {
+        uint64_t *out = frames + offset;
+        const uint64_t *table = MINUTE_TABLE.bits + first;
+
+        // Broadcast OR over the table, vectorized by the compiler
+        for (unsigned i = 0; i < minutes; ++i)
+            out[i] = base | table[i];
+    });
+}
+
+Dcf77BatchCheck dcf77_check_range(int64_t first_utc_minute_ns, uint64_t count, const uint64_t *frames)
+{
+    Dcf77BatchCheck check;
+    check.first_invalid = count;
+
+    for_each_hour(first_utc_minute_ns, count, [frames, &check](uint64_t base, unsigned first, unsigned minutes, uint64_t offset)
+    {
+        const uint64_t *in = frames + offset;
+        const uint64_t *table = MINUTE_TABLE.bits + first;
+
+        // Every expected frame of the hour is valid iff one is: the table only adds
+        // minute BCD with its own parity. If they are not, every minute counts once
+        // as invalid. Otherwise the compare and the parity check per frame stay
+        // branch-free, the slow search for the index only runs on failure.
+        uint64_t invalid = minutes;
+        if (dcf77_frame_valid(base | table[0]))
+        {
+            invalid = 0;
+            for (unsigned i = 0; i < minutes; ++i)
+                invalid += !dcf77_parity_ok(in[i]) | (in[i] != (base | table[i]));
+        }
+
+        if (invalid == 0)
+            return;
+
+        if (check.invalid == 0)
+        {
+            for (unsigned i = 0; i < minutes; ++i)
+            {
+                if (!dcf77_frame_valid(in[i]) || in[i] != (base | table[i]))
+                {
+                    check.first_invalid = offset + i;
+                    break;
+                }
+            }
+        }
+
+        check.invalid += invalid;
+    });
+
+    return check;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename Fn>
+static void for_each_slice(uint64_t count, unsigned threads, Fn fn)
+{
+    if (threads < 2 || count < threads * MINUTES_PER_HOUR)
+    {
+        fn(0, 0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    const uint64_t slice = (count + threads - 1) / threads;
+
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        const uint64_t begin = t * slice;
+        const uint64_t end   = begin + slice < count ? begin + slice : count;
+
+        if (begin < end)
+            workers.emplace_back(fn, t, begin, end - begin);
+    }
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void dcf77_encode_range_parallel(int64_t first_utc_minute_ns, uint64_t count, uint64_t *frames, unsigned threads)
+{
+    for_each_slice(count, threads, [=](unsigned, uint64_t begin, uint64_t length)
+    {
+        dcf77_encode_range(first_utc_minute_ns + static_cast<int64_t>(begin) * NS_PER_MINUTE, length, frames + begin);
+    });
+}
+
+Dcf77BatchCheck dcf77_check_range_parallel(int64_t first_utc_minute_ns, uint64_t count, const uint64_t *frames,
+                                           unsigned threads)
+{
+    std::vector<Dcf77BatchCheck> slices(threads ? threads : 1);
+    std::vector<uint64_t> begins(slices.size(), 0);
+
+    for_each_slice(count, threads, [&](unsigned t, uint64_t begin, uint64_t length)
+    {
+        slices[t] = dcf77_check_range(first_utc_minute_ns + static_cast<int64_t>(begin) * NS_PER_MINUTE, length,
+                                      frames + begin);
+        begins[t] = begin;
+    });
+
+    Dcf77BatchCheck check;
+    check.first_invalid = count;
+
+    for (size_t t = 0; t < slices.size(); ++t)
+    {
+        if (slices[t].invalid && check.first_invalid == count)
+            check.first_invalid = begins[t] + slices[t].first_invalid;
+        check.invalid += slices[t].invalid;
+    }
+
+    return check;
+}
@@ -0,0 +1,44 @@
+#ifndef DCF77_BATCH_H
+#define DCF77_BATCH_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+// Packed frame file: this header followed by count little-endian uint64 frame
+// words (TEST_DCF77_FRAME layout), one per consecutive UTC minute
+const char     DCF77_BATCH_MAGIC[8]  = {'D', 'C', 'F', '7', '7', 'F', 'R', 'M'};
+const uint32_t DCF77_BATCH_VERSION   = 1;
+
+struct Dcf77BatchHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    int64_t  first_utc_minute_ns;
+    uint64_t count;
+};
+
+struct Dcf77BatchCheck
+{
+    uint64_t invalid = 0;       // frames failing dcf77_frame_valid() or differing from the encoder
+    uint64_t first_invalid = 0; // index of the first one, count if none
+};
+
+//------------------------------------------------------------------------------
+
+// Frames for count consecutive minutes starting at a UTC minute boundary. All
+// minutes of a UTC hour share date, hour, zone and announcement (CET/CEST
+// offsets are whole hours), so each hour is encoded once and its minutes are
+// OR-ed in from a compile-time table of minute BCD + P1 words.
+void dcf77_encode_range(int64_t first_utc_minute_ns, uint64_t count, uint64_t *frames);
+
+// Check frames against the same range, every frame is also validated on its own
+Dcf77BatchCheck dcf77_check_range(int64_t first_utc_minute_ns, uint64_t count, const uint64_t *frames);
+
+// Same, split into contiguous slices over the given number of threads
+void dcf77_encode_range_parallel(int64_t first_utc_minute_ns, uint64_t count, uint64_t *frames, unsigned threads);
+Dcf77BatchCheck dcf77_check_range_parallel(int64_t first_utc_minute_ns, uint64_t count, const uint64_t *frames,
+                                           unsigned threads);
+
+#endif // DCF77_BATCH_H
@@ -0,0 +1,197 @@
+#include "dcf77_encoder.h"
+
+#include <chrono>
+
+#include "dcf77_frame.h"
+#include "mono_clock.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+const int64_t SECONDS_PER_DAY = 86400;
+
+const int64_t CET_OFFSET_NS   = 1 * 3600 * NS_PER_S;
+const int64_t CEST_OFFSET_NS  = 2 * 3600 * NS_PER_S;
+const int64_t ANNOUNCE_HOUR_NS = 3600 * NS_PER_S;
+
+//------------------------------------------------------------------------------
+
+// Days since 1970-01-01 <-> proleptic Gregorian date (H. Hinnant's algorithms)
+int64_t days_from_civil(int year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+CivilDate civil_from_days(int64_t days)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp  = (5 * doy + 2) / 153;
+
+    CivilDate date;
+    date.day   = doy - (153 * mp + 2) / 5 + 1;
+    date.month = mp < 10 ? mp + 3 : mp - 9;
+    date.year  = static_cast<int>(yoe + era * 400) + (date.month <= 2);
+    return date;
+}
+
+// ISO weekday, 1 = Monday .. 7 = Sunday (1970-01-01 was a Thursday)
+static unsigned weekday_from_days(int64_t days)
+{
+    return static_cast<unsigned>(((days + 3) % 7 + 7) % 7) + 1;
+}
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// 01:00 UTC on the last Sunday of the given month (EU summer time rule)
+static int64_t eu_change_utc_ns(int year, unsigned month)
+{
+    const int64_t last_day = days_from_civil(year, month + 1, 1) - 1;
+    const int64_t sunday   = last_day - (weekday_from_days(last_day) % 7);
+    return (sunday * SECONDS_PER_DAY + 3600) * NS_PER_S;
+}
+
+//------------------------------------------------------------------------------
+
+uint64_t dcf77_encode_frame(int64_t utc_minute_ns)
+{
+    const int year = civil_from_days(floor_div(utc_minute_ns, SECONDS_PER_DAY * NS_PER_S)).year;
+
+    const int64_t summer_start = eu_change_utc_ns(year, 3);
+    const int64_t summer_end   = eu_change_utc_ns(year, 10);
+
+    const bool summer   = utc_minute_ns >= summer_start && utc_minute_ns < summer_end;
+    const bool announce = (utc_minute_ns >= summer_start - ANNOUNCE_HOUR_NS && utc_minute_ns < summer_start) ||
+                          (utc_minute_ns >= summer_end - ANNOUNCE_HOUR_NS && utc_minute_ns < summer_end);
+
+    const int64_t local_s = floor_div(utc_minute_ns + (summer ? CEST_OFFSET_NS : CET_OFFSET_NS), NS_PER_S);
+    const int64_t days    = floor_div(local_s, SECONDS_PER_DAY);
+    const int64_t seconds = local_s - days * SECONDS_PER_DAY;
+
+    const CivilDate date = civil_from_days(days);
+
+    Dcf77Time time;
+    time.year     = static_cast<unsigned>(date.year);
+    time.month    = date.month;
+    time.day      = date.day;
+    time.weekday  = weekday_from_days(days);
+    time.hour     = static_cast<unsigned>(seconds / 3600);
+    time.minute   = static_cast<unsigned>(seconds / 60 % 60);
+    time.summer   = summer;
+    time.announce = announce;
+
+    return dcf77_encode(time);
+}
+
+int64_t dcf77_frame_utc_minute_ns(uint64_t frame_bits)
+{
+    const Dcf77Time time = dcf77_decode(frame_bits);
+
+    const int64_t local_s = days_from_civil(static_cast<int>(time.year), time.month, time.day) * SECONDS_PER_DAY
+                            + time.hour * 3600 + time.minute * 60;
+
+    return local_s * NS_PER_S - (time.summer ? CEST_OFFSET_NS : CET_OFFSET_NS);
+}
+
+//------------------------------------------------------------------------------
+
+void FrameDoubleBuffer::publish(const Dcf77Frame &frame)
+{
+    const uint32_t sequence = m_sequence.load(std::memory_order_relaxed) + 1;
+    FrameSlot &slot = m_slots[sequence & 1u];
+
+    // Keeps the previous sequence store ahead of the slot stores: a reader
+    // whose copy picked up one of them then sees the sequence moved on
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.utc_minute_ns.store(frame.utc_minute_ns, std::memory_order_relaxed);
+    slot.bits.store(frame.bits, std::memory_order_relaxed);
+
+    m_sequence.store(sequence, std::memory_order_release);
+}
+
+bool FrameDoubleBuffer::latest(Dcf77Frame &frame) const
+{
+    while (true)
+    {
+        const uint32_t before = m_sequence.load(std::memory_order_acquire);
+        if (before == 0)
+            return false;
+
+        const FrameSlot &slot = m_slots[before & 1u];
+        frame.utc_minute_ns   = slot.utc_minute_ns.load(std::memory_order_relaxed);
+        frame.bits            = slot.bits.load(std::memory_order_relaxed);
+
+        // publish() writes its slot before it bumps the sequence, so by the time
+        // the sequence reads before + 1 the publish after it may already be
+        // rewriting this slot. Only an unchanged sequence proves a clean copy.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+FrameEncoder::FrameEncoder(FrameDoubleBuffer &frames)
+    : m_frames(frames)
+{
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    stop();
+}
+
+void FrameEncoder::start(int64_t first_utc_minute_ns)
+{
+    m_frames.publish({first_utc_minute_ns, dcf77_encode_frame(first_utc_minute_ns)});
+
+    m_stop   = false;
+    m_thread = std::thread(&FrameEncoder::run, this, first_utc_minute_ns + NS_PER_MINUTE);
+}
+
+void FrameEncoder::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeup.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void FrameEncoder::run(int64_t next_utc_minute_ns)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stop)
+    {
+        // The frame announcing minute A is on air during [A - 1 min, A). Build
+        // it half way through its predecessor's minute, so a publish never
+        // races with the transmitter fetching a frame at the minute boundary.
+        const int64_t build_at_ns = next_utc_minute_ns - 2 * NS_PER_MINUTE + NS_PER_MINUTE / 2;
+        const int64_t wait_ns     = build_at_ns - utc_now_ns();
+
+        if (wait_ns > 0)
+        {
+            m_wakeup.wait_for(lock, std::chrono::nanoseconds(wait_ns));
+            continue;
+        }
+
+        m_frames.publish({next_utc_minute_ns, dcf77_encode_frame(next_utc_minute_ns)});
+        next_utc_minute_ns += NS_PER_MINUTE;
+    }
+}
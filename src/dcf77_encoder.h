@@ -0,0 +1,90 @@
+#ifndef DCF77_ENCODER_H
+#define DCF77_ENCODER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------
+
+// One minute of DCF77 data. bits uses the TEST_DCF77_FRAME layout: DCF77 bit 0
+// is bit 58 of the word and is transmitted first.
+struct Dcf77Frame
+{
+    int64_t  utc_minute_ns; // UTC minute the frame announces (valid at its minute marker)
+    uint64_t bits;
+};
+
+// Build the frame announcing the given UTC minute in German legal time:
+// BCD time and date, the three even parity bits, CET/CEST (bits 17-18) and the
+// time change announcement (bit 16) during the hour before a change.
+uint64_t dcf77_encode_frame(int64_t utc_minute_ns);
+
+// UTC minute a frame announces, the inverse of dcf77_encode_frame
+int64_t dcf77_frame_utc_minute_ns(uint64_t frame_bits);
+
+struct CivilDate
+{
+    int year;
+    unsigned month;     // 1..12
+    unsigned day;       // 1..31
+};
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back
+int64_t days_from_civil(int year, unsigned month, unsigned day);
+CivilDate civil_from_days(int64_t days);
+
+//------------------------------------------------------------------------------
+
+// Single producer / single consumer hand-over of the next frame. The producer
+// always fills the slot the consumer is not reading, publishing is a single
+// release store, so the consumer never blocks or allocates.
+class FrameDoubleBuffer
+{
+public:
+    void publish(const Dcf77Frame &frame);
+
+    // Copy of the most recently published frame, false if nothing was published yet
+    bool latest(Dcf77Frame &frame) const;
+
+private:
+    // Atomic words, a reader may copy a slot while a later publish rewrites it
+    struct FrameSlot
+    {
+        std::atomic<int64_t>  utc_minute_ns{0};
+        std::atomic<uint64_t> bits{0};
+    };
+
+    FrameSlot m_slots[2];
+    std::atomic<uint32_t> m_sequence{0};
+};
+
+//------------------------------------------------------------------------------
+
+// Background encoder: while minute N is on air it builds and publishes the
+// frame for minute N+1, so latest() returns N+1 from the middle of minute N on.
+class FrameEncoder
+{
+public:
+    explicit FrameEncoder(FrameDoubleBuffer &frames);
+    ~FrameEncoder();
+
+    // Publish the frame for first_utc_minute_ns immediately, then keep one
+    // frame ahead of the transmitter until stop()
+    void start(int64_t first_utc_minute_ns);
+    void stop();
+
+private:
+    void run(int64_t next_utc_minute_ns);
+
+    FrameDoubleBuffer &m_frames;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stop = false;
+};
+
+#endif // DCF77_ENCODER_H
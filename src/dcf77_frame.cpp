@@ -0,0 +1,114 @@
+#include "dcf77_frame.h"
+
+#include <charconv>
+#include <cstring>
+
+//------------------------------------------------------------------------------
+
+// Round trip of a frame with all parity bits set
+static_assert(dcf77_encode({2099, 12, 31, 4, 23, 59, false, false}) ==
+              dcf77_encode(dcf77_decode(dcf77_encode({2099, 12, 31, 4, 23, 59, false, false}))), "codec round trip");
+static_assert(dcf77_parity_ok(dcf77_encode({2099, 12, 31, 4, 23, 59, false, false})), "encoder parity");
+static_assert(dcf77_frame_valid(dcf77_encode({2099, 12, 31, 4, 23, 59, false, false})), "encoder ranges");
+static_assert(!dcf77_frame_valid(0), "empty frame");
+static_assert(dcf77_from_air_order(dcf77_to_air_order(0x7FFFFFFFFFFFFFFULL)) == 0x7FFFFFFFFFFFFFFULL, "bit order");
+
+//------------------------------------------------------------------------------
+
+// "00".."99"
+struct TwoDigitTable
+{
+    char digits[200];
+
+    constexpr TwoDigitTable()
+        : digits()
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            digits[2 * i]     = static_cast<char>('0' + i / 10);
+            digits[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+
+static constexpr TwoDigitTable TWO_DIGITS;
+
+static const char WEEKDAY_NAMES[8][4] = {"???", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+
+// Indexed by Dcf77Zone (Z1 | Z2 << 1), 0 and 3 are invalid
+static const char ZONE_NAMES[4][5] = {"Z??", "CEST", "CET", "Z??"};
+
+// Chunk size of dcf77_write_frames, whole records only
+const size_t WRITE_CHUNK_BYTES = 1 << 16;
+
+static char *put_two_digits(char *out, unsigned value)
+{
+    std::memcpy(out, &TWO_DIGITS.digits[2 * (value % 100)], 2);
+    return out + 2;
+}
+
+static char *put_text(char *out, const char *text)
+{
+    const size_t length = std::strlen(text);
+    std::memcpy(out, text, length);
+    return out + length;
+}
+
+//------------------------------------------------------------------------------
+
+size_t dcf77_format_frame(uint64_t frame_bits, char *out)
+{
+    const uint64_t air = dcf77_to_air_order(frame_bits);
+    char *p = out;
+
+    // Invalid frames can decode to years past 2099, to_chars keeps them exact
+    p = std::to_chars(p, out + 5, 2000 + Dcf77Year::get(air)).ptr;
+    *p++ = '-';
+    p = put_two_digits(p, Dcf77Month::get(air));
+    *p++ = '-';
+    p = put_two_digits(p, Dcf77Day::get(air));
+    *p++ = 'T';
+    p = put_two_digits(p, Dcf77Hour::get(air));
+    *p++ = ':';
+    p = put_two_digits(p, Dcf77Minute::get(air));
+    *p++ = ' ';
+    p = put_text(p, WEEKDAY_NAMES[Dcf77Weekday::get(air)]);
+    *p++ = ' ';
+    p = put_text(p, ZONE_NAMES[Dcf77Zone::get(air)]);
+
+    if (Dcf77Announce::get(air))
+        p = put_text(p, " A1");
+    if (Dcf77LeapSecond::get(air))
+        p = put_text(p, " A2");
+
+    p = put_text(p, dcf77_parity_ok(frame_bits) ? " parity ok" : " parity bad");
+
+    return static_cast<size_t>(p - out);
+}
+
+std::string dcf77_frame_to_string(uint64_t frame_bits)
+{
+    char text[DCF77_FRAME_TEXT_MAX];
+    return std::string(text, dcf77_format_frame(frame_bits, text));
+}
+
+bool dcf77_write_frames(std::FILE *file, const uint64_t *frames, size_t count)
+{
+    char chunk[WRITE_CHUNK_BYTES];
+    size_t used = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (used + DCF77_FRAME_TEXT_MAX + 1 > sizeof(chunk))
+        {
+            if (std::fwrite(chunk, 1, used, file) != used)
+                return false;
+            used = 0;
+        }
+
+        used += dcf77_format_frame(frames[i], chunk + used);
+        chunk[used++] = '\n';
+    }
+
+    return std::fwrite(chunk, 1, used, file) == used;
+}
@@ -0,0 +1,209 @@
+#ifndef DCF77_FRAME_H
+#define DCF77_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+//------------------------------------------------------------------------------
+
+// Frame words use the TEST_DCF77_FRAME layout: DCF77 bit i is bit (58 - i) of
+// the word, so bit 0 is sent first. Fields are LSB first on air, which makes
+// them bit-reversed in that layout; the codec reverses the word once and then
+// works on "air order" (DCF77 bit i = word bit i) with plain shifts and masks.
+
+constexpr uint64_t dcf77_reverse64(uint64_t v)
+{
+    v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+    v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+    return (v >> 32) | (v << 32);
+}
+
+constexpr unsigned dcf77_popcount64(uint64_t v)
+{
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned>((v * 0x0101010101010101ULL) >> 56);
+}
+
+constexpr uint64_t dcf77_to_air_order(uint64_t frame_bits)
+{
+    return dcf77_reverse64(frame_bits) >> 5;
+}
+
+constexpr uint64_t dcf77_from_air_order(uint64_t air_bits)
+{
+    return dcf77_reverse64(air_bits << 5);
+}
+
+//------------------------------------------------------------------------------
+
+// Compile-time field descriptor, First/Width in DCF77 bit numbers
+template <unsigned First, unsigned Width>
+struct Dcf77Field
+{
+    static_assert(Width > 0 && First + Width <= 59, "field outside the frame");
+
+    static constexpr uint64_t MASK = ((1ULL << Width) - 1) << First;
+
+    static constexpr unsigned get(uint64_t air_bits)
+    {
+        return static_cast<unsigned>((air_bits & MASK) >> First);
+    }
+
+    static constexpr uint64_t put(uint64_t air_bits, unsigned value)
+    {
+        return (air_bits & ~MASK) | ((static_cast<uint64_t>(value) << First) & MASK);
+    }
+
+    // Even parity over the field (parity bit included when it is the last bit)
+    static constexpr bool even(uint64_t air_bits)
+    {
+        return (dcf77_popcount64(air_bits & MASK) & 1u) == 0;
+    }
+};
+
+// Two-digit BCD value, units nibble first
+template <unsigned First, unsigned TensWidth>
+struct Dcf77BcdField
+{
+    using Units = Dcf77Field<First, 4>;
+    using Tens  = Dcf77Field<First + 4, TensWidth>;
+
+    static constexpr unsigned get(uint64_t air_bits)
+    {
+        return Units::get(air_bits) + 10 * Tens::get(air_bits);
+    }
+
+    static constexpr uint64_t put(uint64_t air_bits, unsigned value)
+    {
+        return Tens::put(Units::put(air_bits, value % 10), value / 10);
+    }
+};
+
+using Dcf77Weather     = Dcf77Field<1, 14>;
+using Dcf77CallBit     = Dcf77Field<15, 1>;
+using Dcf77Announce    = Dcf77Field<16, 1>;     // A1, CET/CEST change within the hour
+using Dcf77Zone        = Dcf77Field<17, 2>;     // Z1 (CEST) | Z2 (CET) << 1
+using Dcf77LeapSecond  = Dcf77Field<19, 1>;     // A2
+using Dcf77TimeStart   = Dcf77Field<20, 1>;     // always 1
+using Dcf77Minute      = Dcf77BcdField<21, 3>;
+using Dcf77Hour        = Dcf77BcdField<29, 2>;
+using Dcf77Day         = Dcf77BcdField<36, 2>;
+using Dcf77Weekday     = Dcf77Field<42, 3>;     // 1 = Monday .. 7 = Sunday
+using Dcf77Month       = Dcf77BcdField<45, 1>;
+using Dcf77Year        = Dcf77BcdField<50, 4>;  // years since 2000
+
+// Parity groups, each ending with its parity bit (P1, P2, P3)
+using Dcf77MinuteParity = Dcf77Field<21, 8>;
+using Dcf77HourParity   = Dcf77Field<29, 7>;
+using Dcf77DateParity   = Dcf77Field<36, 23>;
+
+using Dcf77MinuteParityBit = Dcf77Field<28, 1>;
+using Dcf77HourParityBit   = Dcf77Field<35, 1>;
+using Dcf77DateParityBit   = Dcf77Field<58, 1>;
+
+//------------------------------------------------------------------------------
+
+struct Dcf77Time
+{
+    unsigned year;      // 2000..2099
+    unsigned month;
+    unsigned day;
+    unsigned weekday;   // 1 = Monday
+    unsigned hour;
+    unsigned minute;
+    bool     summer;    // CEST
+    bool     announce;
+};
+
+constexpr Dcf77Time dcf77_decode(uint64_t frame_bits)
+{
+    const uint64_t air = dcf77_to_air_order(frame_bits);
+
+    return {2000 + Dcf77Year::get(air), Dcf77Month::get(air), Dcf77Day::get(air), Dcf77Weekday::get(air),
+            Dcf77Hour::get(air), Dcf77Minute::get(air), Dcf77Zone::get(air) == 0x1u, Dcf77Announce::get(air) != 0};
+}
+
+// Fills the time fields and the three parity bits, weather/call bits stay 0
+constexpr uint64_t dcf77_encode(const Dcf77Time &time)
+{
+    uint64_t air = 0;
+
+    air = Dcf77Announce::put(air, time.announce ? 1u : 0u);
+    air = Dcf77Zone::put(air, time.summer ? 0x1u : 0x2u);
+    air = Dcf77TimeStart::put(air, 1u);
+    air = Dcf77Minute::put(air, time.minute);
+    air = Dcf77Hour::put(air, time.hour);
+    air = Dcf77Day::put(air, time.day);
+    air = Dcf77Weekday::put(air, time.weekday);
+    air = Dcf77Month::put(air, time.month);
+    air = Dcf77Year::put(air, time.year % 100);
+
+    // A parity bit equals the parity of its group while it is still clear
+    air = Dcf77MinuteParityBit::put(air, !Dcf77MinuteParity::even(air));
+    air = Dcf77HourParityBit::put(air, !Dcf77HourParity::even(air));
+    air = Dcf77DateParityBit::put(air, !Dcf77DateParity::even(air));
+
+    return dcf77_from_air_order(air);
+}
+
+// All three parity groups even, no branches. The group masks are moved into
+// frame layout at compile time, so no bit reversal is needed per frame.
+constexpr bool dcf77_parity_ok(uint64_t frame_bits)
+{
+    constexpr uint64_t MINUTE_GROUP = dcf77_from_air_order(Dcf77MinuteParity::MASK);
+    constexpr uint64_t HOUR_GROUP   = dcf77_from_air_order(Dcf77HourParity::MASK);
+    constexpr uint64_t DATE_GROUP   = dcf77_from_air_order(Dcf77DateParity::MASK);
+
+    return ((dcf77_popcount64(frame_bits & MINUTE_GROUP) | dcf77_popcount64(frame_bits & HOUR_GROUP) |
+             dcf77_popcount64(frame_bits & DATE_GROUP)) & 1u) == 0;
+}
+
+// Everything a receiver checks on a single frame: parity, start of time bit,
+// exactly one of Z1/Z2, BCD digits and field ranges. Branch-free so batch
+// validation loops vectorize.
+constexpr bool dcf77_frame_valid(uint64_t frame_bits)
+{
+    const uint64_t air = dcf77_to_air_order(frame_bits);
+
+    const unsigned zone    = Dcf77Zone::get(air);
+    const unsigned minute  = Dcf77Minute::get(air);
+    const unsigned hour    = Dcf77Hour::get(air);
+    const unsigned day     = Dcf77Day::get(air);
+    const unsigned weekday = Dcf77Weekday::get(air);
+    const unsigned month   = Dcf77Month::get(air);
+
+    return dcf77_parity_ok(frame_bits)
+         & (Dcf77TimeStart::get(air) == 1)
+         & (((zone ^ (zone >> 1)) & 1u) == 1)
+         & (Dcf77Minute::Units::get(air) <= 9) & (minute <= 59)
+         & (Dcf77Hour::Units::get(air) <= 9) & (hour <= 23)
+         & (Dcf77Day::Units::get(air) <= 9) & (day >= 1) & (day <= 31)
+         & (weekday >= 1)
+         & (Dcf77Month::Units::get(air) <= 9) & (month >= 1) & (month <= 12)
+         & (Dcf77Year::Units::get(air) <= 9) & (Dcf77Year::Tens::get(air) <= 9);
+}
+
+//------------------------------------------------------------------------------
+
+// Longest record dcf77_format_frame() writes, newline not included
+const size_t DCF77_FRAME_TEXT_MAX = 48;
+
+// "2025-11-24T22:48 Mon CET A1 A2 parity ok" into out (no terminator), returns
+// the length. A1/A2 only appear when set. No locale, no allocation.
+size_t dcf77_format_frame(uint64_t frame_bits, char *out);
+
+// Same record as a string, for one-off console output
+std::string dcf77_frame_to_string(uint64_t frame_bits);
+
+// Newline-delimited records for a whole array of frames, buffered in fixed
+// chunks; returns false if the file write failed
+bool dcf77_write_frames(std::FILE *file, const uint64_t *frames, size_t count);
+
+#endif // DCF77_FRAME_H
@@ -0,0 +1,203 @@
+#include "dds_state.h"
+
+//------------------------------------------------------------------------------
+
+DdsStateCache::DdsStateCache(WORD dev, const DdsCalls &calls)
+    : m_dev(dev), m_calls(calls)
+{
+}
+
+void DdsStateCache::invalidate()
+{
+    m_known = 0;
+}
+
+bool DdsStateCache::holds(uint16_t reg, bool equal)
+{
+    if ((m_known & reg) && equal)
+    {
+        ++m_stats.redundant;
+        return true;
+    }
+
+    ++m_stats.issued;
+    return false;
+}
+
+bool DdsStateCache::landed(uint16_t reg, bool ok)
+{
+    if (ok)
+        m_known |= reg;
+    else
+        m_known &= static_cast<uint16_t>(~reg);
+    return ok;
+}
+
+// A dropped write returns the value the register holds, which is what the SDK
+// manual says the ddsSDKSet* calls return: the previous value
+WORD DdsStateCache::set_wave_type(WORD wave_type)
+{
+    if (holds(REG_WAVE_TYPE, m_device.wave_type == wave_type))
+        return wave_type;
+
+    const WORD previous = m_calls.set_wave_type(m_dev, wave_type);
+    landed(REG_WAVE_TYPE, true);
+    m_device.wave_type = wave_type;
+    return previous;
+}
+
+// A DDS that achieved no frequency did not take the write
+float DdsStateCache::set_frequency(float frequency_hz)
+{
+    if (holds(REG_FREQUENCY, m_device.frequency_hz == frequency_hz))
+        return m_device.achieved_hz;
+
+    const float achieved_hz = m_calls.set_frequency(m_dev, frequency_hz);
+    if (landed(REG_FREQUENCY, achieved_hz > 0.0f))
+    {
+        m_device.frequency_hz = frequency_hz;
+        m_device.achieved_hz  = achieved_hz;
+    }
+    return achieved_hz;
+}
+
+WORD DdsStateCache::set_amplitude(WORD amplitude_mv)
+{
+    if (holds(REG_AMPLITUDE, m_device.amplitude_mv == amplitude_mv))
+        return amplitude_mv;
+
+    const WORD previous = m_calls.set_amplitude(m_dev, amplitude_mv);
+    landed(REG_AMPLITUDE, true);
+    m_device.amplitude_mv = amplitude_mv;
+    return previous;
+}
+
+short DdsStateCache::set_offset(short offset_mv)
+{
+    if (holds(REG_OFFSET, m_device.offset_mv == offset_mv))
+        return offset_mv;
+
+    const short previous = m_calls.set_offset(m_dev, offset_mv);
+    landed(REG_OFFSET, true);
+    m_device.offset_mv = offset_mv;
+    return previous;
+}
+
+ULONG DdsStateCache::set_on_off(bool on)
+{
+    if (holds(REG_ON, m_device.on == on))
+        return HT_OK;
+
+    const ULONG rc = m_calls.set_on_off(m_dev, on ? 1 : 0);
+    if (landed(REG_ON, rc == HT_OK))
+        m_device.on = on;
+    return rc;
+}
+
+ULONG DdsStateCache::set_cmd(USHORT cmd)
+{
+    if (holds(REG_CMD, m_device.cmd == cmd))
+        return HT_OK;
+
+    const ULONG rc = m_calls.set_cmd(m_dev, cmd);
+    if (landed(REG_CMD, rc == HT_OK))
+        m_device.cmd = cmd;
+    return rc;
+}
+
+WORD DdsStateCache::set_burst_cycles(WORD cycles)
+{
+    if (holds(REG_BURST_CYCLES, m_device.burst_cycles == cycles))
+        return cycles;
+
+    const WORD previous = m_calls.set_burst_num(m_dev, cycles);
+    landed(REG_BURST_CYCLES, true);
+    m_device.burst_cycles = cycles;
+    return previous;
+}
+
+WORD DdsStateCache::set_faoc(float frequency_hz, WORD amplitude_mv, short offset_mv, float am_depth)
+{
+    const uint16_t regs = REG_FREQUENCY | REG_AMPLITUDE | REG_OFFSET | REG_AM_DEPTH;
+    const bool equal   = (m_known & regs) == regs && m_device.frequency_hz == frequency_hz
+                         && m_device.amplitude_mv == amplitude_mv && m_device.offset_mv == offset_mv
+                         && m_device.am_depth == am_depth;
+
+    if (holds(regs, equal))
+        return HT_OK;
+
+    const WORD rc = m_calls.set_faoc(m_dev, frequency_hz, amplitude_mv, offset_mv, 0, am_depth, 0.0);
+    if (landed(regs, rc == HT_OK))
+    {
+        m_device.frequency_hz = frequency_hz;
+        m_device.achieved_hz  = frequency_hz;
+        m_device.amplitude_mv = amplitude_mv;
+        m_device.offset_mv    = offset_mv;
+        m_device.am_depth     = am_depth;
+    }
+    return rc;
+}
+
+ULONG DdsStateCache::set_am_frequency(double frequency_hz)
+{
+    if (holds(REG_AM_FREQUENCY, m_device.am_frequency_hz == frequency_hz))
+        return HT_OK;
+
+    const ULONG rc = m_calls.set_amfm_frequency(m_dev, frequency_hz);
+    if (landed(REG_AM_FREQUENCY, rc == HT_OK))
+        m_device.am_frequency_hz = frequency_hz;
+    return rc;
+}
+
+//------------------------------------------------------------------------------
+
+void DdsStateCache::stage(uint16_t reg)
+{
+    if (m_pending & reg)
+        ++m_stats.coalesced;
+
+    m_pending |= reg;
+}
+
+void DdsStateCache::stage_wave_type(WORD wave_type)
+{
+    stage(REG_WAVE_TYPE);
+    m_staged.wave_type = wave_type;
+}
+
+void DdsStateCache::stage_frequency(float frequency_hz)
+{
+    stage(REG_FREQUENCY);
+    m_staged.frequency_hz = frequency_hz;
+}
+
+void DdsStateCache::stage_amplitude(WORD amplitude_mv)
+{
+    stage(REG_AMPLITUDE);
+    m_staged.amplitude_mv = amplitude_mv;
+}
+
+void DdsStateCache::stage_offset(short offset_mv)
+{
+    stage(REG_OFFSET);
+    m_staged.offset_mv = offset_mv;
+}
+
+uint32_t DdsStateCache::commit()
+{
+    const uint16_t pending = m_pending;
+    const uint64_t issued = m_stats.issued;
+
+    m_pending = 0;
+
+    if (pending & REG_WAVE_TYPE)
+        set_wave_type(m_staged.wave_type);
+    if (pending & REG_FREQUENCY)
+        set_frequency(m_staged.frequency_hz);
+    if (pending & REG_AMPLITUDE)
+        set_amplitude(m_staged.amplitude_mv);
+    if (pending & REG_OFFSET)
+        set_offset(m_staged.offset_mv);
+
+    return static_cast<uint32_t>(m_stats.issued - issued);
+}
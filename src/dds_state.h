@@ -0,0 +1,131 @@
+#ifndef DDS_STATE_H
+#define DDS_STATE_H
+
+#include <cstdint>
+
+#include "hantek_sdk.h"
+
+//------------------------------------------------------------------------------
+
+// DDS setters of the bound backend, the cache calls nothing else
+struct DdsCalls
+{
+    PFN_ddsSDKSetWaveType set_wave_type;
+    PFN_ddsSDKSetFre      set_frequency;
+    PFN_ddsSDKSetAmp      set_amplitude;
+    PFN_ddsSDKSetOffset   set_offset;
+    PFN_ddsSetOnOff       set_on_off;
+    PFN_ddsSetCmd         set_cmd;
+    PFN_ddsSDKSetBurstNum set_burst_num;
+    PFN_ddsSetFAOC        set_faoc;
+    PFN_ddsSetAMFMFreq    set_amfm_frequency;
+};
+
+// Last value written to every DDS register the transmitter uses
+struct DdsRegisters
+{
+    WORD   wave_type;
+    float  frequency_hz;
+    float  achieved_hz;     // what the DDS made of frequency_hz
+    WORD   amplitude_mv;
+    short  offset_mv;
+    bool   on;
+    USHORT cmd;
+    WORD   burst_cycles;
+    float  am_depth;
+    double am_frequency_hz;     // modulator of the built-in AM generator
+};
+
+struct DdsCacheStats
+{
+    uint64_t issued;        // calls that reached the device
+    uint64_t redundant;     // writes of the value the register already held
+    uint64_t coalesced;     // staged writes replaced by a later one before commit()
+};
+
+//------------------------------------------------------------------------------
+
+// Write-through cache of the DDS registers in front of the SDK setters. A write
+// of the value the device already holds returns without a USB round trip, with
+// HT_OK or the held value for the setters that return one. Settings staged for
+// the same instant are coalesced (last write wins) and go out together on
+// commit(), only the registers that changed.
+//
+// The cache starts and, after invalidate(), restarts with every register
+// unknown so the next write of each always reaches the device. A register
+// becomes known only through a write that succeeded; a failed ddsSetOnOff,
+// ddsSetCmd, ddsSetFAOC or ddsSetAMFMFreq, or a ddsSDKSetFre that achieved
+// nothing, leaves it unknown so the same value is sent again. The other
+// ddsSDKSet* calls return a register value and report no failure, their writes
+// count as landed; a lost device is caught by DeviceRecovery, which invalidates
+// the cache. Single thread.
+class DdsStateCache
+{
+public:
+    DdsStateCache(WORD dev, const DdsCalls &calls);
+
+    WORD device() const { return m_dev; }
+
+    // Device state no longer known, e.g. after dsoInitHard
+    void invalidate();
+
+    WORD  set_wave_type(WORD wave_type);
+    WORD  set_amplitude(WORD amplitude_mv);
+    short set_offset(short offset_mv);
+    ULONG set_on_off(bool on);
+
+    // The frequency the DDS achieved, from ddsSDKSetFre or the cache
+    float set_frequency(float frequency_hz);
+    ULONG set_cmd(USHORT cmd);
+    WORD  set_burst_cycles(WORD cycles);
+
+    // Carrier, amplitude, offset and AM depth in one ddsSetFAOC call
+    WORD  set_faoc(float frequency_hz, WORD amplitude_mv, short offset_mv, float am_depth);
+
+    // Modulation frequency of the built-in AM generator
+    ULONG set_am_frequency(double frequency_hz);
+
+    void stage_wave_type(WORD wave_type);
+    void stage_frequency(float frequency_hz);
+    void stage_amplitude(WORD amplitude_mv);
+    void stage_offset(short offset_mv);
+
+    // Writes the staged registers that differ from the device in the fixed order
+    // wave type, frequency, amplitude, offset. Returns the number of SDK calls made.
+    uint32_t commit();
+
+    const DdsCacheStats &stats() const { return m_stats; }
+
+private:
+    enum Register : uint16_t
+    {
+        REG_WAVE_TYPE    = 1 << 0,
+        REG_FREQUENCY    = 1 << 1,
+        REG_AMPLITUDE    = 1 << 2,
+        REG_OFFSET       = 1 << 3,
+        REG_ON           = 1 << 4,
+        REG_CMD          = 1 << 5,
+        REG_BURST_CYCLES = 1 << 6,
+        REG_AM_DEPTH     = 1 << 7,
+        REG_AM_FREQUENCY = 1 << 8,
+    };
+
+    // True if the register is known to hold the value, counts the dropped write
+    bool holds(uint16_t reg, bool equal);
+
+    // Known after a successful write, unknown after a failed one. Returns ok.
+    bool landed(uint16_t reg, bool ok);
+    void stage(uint16_t reg);
+
+    WORD m_dev;
+    DdsCalls m_calls;
+
+    DdsRegisters m_device = {};     // valid where m_known is set
+    DdsRegisters m_staged = {};     // valid where m_pending is set
+    uint16_t m_known = 0;
+    uint16_t m_pending = 0;
+
+    DdsCacheStats m_stats = {};
+};
+
+#endif // DDS_STATE_H
@@ -0,0 +1,142 @@
+#include "device_discovery.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+// Slot result, written by its probe thread only
+struct SlotProbe
+{
+    bool       connected;
+    DeviceInfo info;
+};
+
+double ns_to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / NS_PER_MS;
+}
+
+// SDK strings as a single printable word, the calibration cache is whitespace separated
+void read_text(BOOL (WINAPI *read)(WORD, UCHAR *), WORD index, char (&text)[DEVICE_SN_MAX])
+{
+    UCHAR buffer[DEVICE_SN_MAX] = {0};
+    const BOOL rc = read ? read(index, buffer) : 0;
+    buffer[DEVICE_SN_MAX - 1] = 0;
+
+    size_t length = 0;
+    for (; rc && buffer[length] && length + 1 < DEVICE_SN_MAX; ++length)
+        text[length] = (buffer[length] > ' ' && buffer[length] < 0x7f) ? static_cast<char>(buffer[length]) : '_';
+    text[length] = 0;
+
+    if (!length)
+        std::strcpy(text, "unknown");
+}
+
+void probe_slot(const DiscoveryCalls &calls, WORD index, SlotProbe &probe)
+{
+    DeviceInfo &info = probe.info;
+    info.index = index;
+
+    const int64_t start_ns = mono_now_ns();
+    probe.connected = calls.connect(index) == HT_OK;
+    info.connect_ns = mono_now_ns() - start_ns;
+
+    if (!probe.connected)
+        return;
+
+    read_text(calls.get_name, index, info.name);
+    read_text(calls.get_serial, index, info.serial);
+    info.fpga_version = calls.get_fpga_version ? calls.get_fpga_version(index) : 0;
+
+    info.identify_ns = mono_now_ns() - start_ns - info.connect_ns;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+bool discover_devices(const DiscoveryCalls &calls, DeviceInventory &inventory)
+{
+    inventory.count  = 0;
+    inventory.listed = 0;
+    inventory.timing = DiscoveryTiming();
+
+    short dev_info[DEVICE_SLOTS] = {0};
+
+    int64_t start_ns = mono_now_ns();
+    const WORD rc = calls.search(dev_info);
+    inventory.timing.search_ns = mono_now_ns() - start_ns;
+
+    std::cout << "dsoHTSearchDevice rc = " << rc << "\n";
+    if (rc != HT_OK)
+        return false;
+
+    // The search flags are not trusted alone, every slot is probed like the demos do
+    SlotProbe probes[DEVICE_SLOTS] = {};
+    std::thread threads[DEVICE_SLOTS];
+
+    start_ns = mono_now_ns();
+
+    for (WORD i = 0; i < DEVICE_SLOTS; ++i)
+        threads[i] = std::thread(probe_slot, std::cref(calls), i, std::ref(probes[i]));
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    inventory.timing.probe_ns = mono_now_ns() - start_ns;
+
+    for (WORD i = 0; i < DEVICE_SLOTS; ++i)
+    {
+        const SlotProbe &probe = probes[i];
+        inventory.timing.probe_serial_ns += probe.info.connect_ns + probe.info.identify_ns;
+
+        if (dev_info[i])
+            ++inventory.listed;
+
+        if (!probe.connected)
+            continue;
+
+        DeviceInfo &info = inventory.devices[inventory.count++];
+        info        = probe.info;
+        info.listed = dev_info[i] != 0;
+    }
+
+    return true;
+}
+
+const DeviceInfo *inventory_find(const DeviceInventory &inventory, WORD index)
+{
+    for (uint32_t i = 0; i < inventory.count; ++i)
+    {
+        if (inventory.devices[i].index == index)
+            return &inventory.devices[i];
+    }
+    return nullptr;
+}
+
+void inventory_print(const DeviceInventory &inventory)
+{
+    const DiscoveryTiming &timing = inventory.timing;
+
+    std::cout << "Found: " << inventory.count << " devices (" << inventory.listed << " listed by search), search "
+              << ns_to_ms(timing.search_ns) << " ms, probing " << DEVICE_SLOTS << " slots "
+              << ns_to_ms(timing.probe_ns) << " ms (" << ns_to_ms(timing.probe_serial_ns) << " ms one by one)\n";
+
+    for (uint32_t i = 0; i < inventory.count; ++i)
+    {
+        const DeviceInfo &info = inventory.devices[i];
+
+        std::cout << "  [" << info.index << "] " << info.name << " serial " << info.serial << " FPGA 0x" << std::hex
+                  << std::setw(4) << std::setfill('0') << info.fpga_version << std::dec << std::setfill(' ')
+                  << ", connect " << ns_to_ms(info.connect_ns) << " ms, identify " << ns_to_ms(info.identify_ns)
+                  << " ms" << (info.listed ? "" : ", not listed by search") << "\n";
+    }
+}
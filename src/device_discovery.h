@@ -0,0 +1,61 @@
+#ifndef DEVICE_DISCOVERY_H
+#define DEVICE_DISCOVERY_H
+
+#include <cstdint>
+
+#include "hantek_sdk.h"
+
+//------------------------------------------------------------------------------
+
+struct DiscoveryCalls
+{
+    PFN_dsoHTSearchDevice  search;
+    PFN_dsoHTDeviceConnect connect;
+    PFN_dsoGetDeviceName   get_name;
+    PFN_dsoGetDeviceSN     get_serial;
+    PFN_dsoGetFPGAVersion  get_fpga_version;
+};
+
+// One scope that answered dsoHTDeviceConnect
+struct DeviceInfo
+{
+    WORD    index;
+    bool    listed;                 // also reported by dsoHTSearchDevice
+    char    name[DEVICE_SN_MAX];    // printable words, "unknown" if unreadable
+    char    serial[DEVICE_SN_MAX];
+    WORD    fpga_version;
+    int64_t connect_ns;             // dsoHTDeviceConnect
+    int64_t identify_ns;            // name, serial and FPGA version
+};
+
+// Wall time of each discovery phase
+struct DiscoveryTiming
+{
+    int64_t search_ns;
+    int64_t probe_ns;               // all slots, concurrently
+    int64_t probe_serial_ns;        // sum of the slot probes, what a serial scan would take
+};
+
+// Devices in slot order
+struct DeviceInventory
+{
+    DeviceInfo devices[DEVICE_SLOTS];
+    uint32_t   count;
+    uint32_t   listed;              // slots flagged by dsoHTSearchDevice
+    DiscoveryTiming timing;
+};
+
+//------------------------------------------------------------------------------
+
+// dsoHTSearchDevice, then every slot is probed on its own thread: connect and,
+// if it answers, read name, serial and FPGA version. Unlike the SDK demos'
+// serial connect scan this costs one connect round trip however many scopes
+// are attached. False only if the search itself fails.
+bool discover_devices(const DiscoveryCalls &calls, DeviceInventory &inventory);
+
+// Null if no device answered in that slot
+const DeviceInfo *inventory_find(const DeviceInventory &inventory, WORD index);
+
+void inventory_print(const DeviceInventory &inventory);
+
+#endif // DEVICE_DISCOVERY_H
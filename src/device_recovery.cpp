@@ -0,0 +1,145 @@
+#include "device_recovery.h"
+
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+DeviceRecovery::DeviceRecovery(DdsStateCache &dds, const RecoveryCalls &calls, const DdsSetup &setup,
+                               const RecoveryTuning &tuning)
+    : m_dds(dds), m_calls(calls), m_setup(setup), m_tuning(tuning)
+{
+    m_thread = std::thread(&DeviceRecovery::run, this);
+}
+
+DeviceRecovery::~DeviceRecovery()
+{
+    stop();
+}
+
+void DeviceRecovery::begin(int64_t failed_ns)
+{
+    m_failed_ns.store(failed_ns, std::memory_order_relaxed);
+
+    // The recovery thread may have found the device gone first
+    RecoveryState online = RecoveryState::Online;
+    m_state.compare_exchange_strong(online, RecoveryState::Recovering, std::memory_order_acq_rel);
+}
+
+void DeviceRecovery::probe(int64_t now_ns)
+{
+    if (now_ns - m_probe_asked_ns < m_tuning.probe_ns)
+        return;
+
+    m_probe_asked_ns = now_ns;
+    m_probe_request_ns.store(now_ns, std::memory_order_release);
+}
+
+OutageRecord DeviceRecovery::resume(int64_t now_ns)
+{
+    const int64_t failed_ns = m_failed_ns.load(std::memory_order_relaxed);
+
+    OutageRecord record;
+    record.recovery_ns = m_ready_ns - failed_ns;
+    record.outage_ns   = now_ns - failed_ns;
+    record.attempts    = m_attempts;
+
+    m_stats.recovery.add(record.recovery_ns);
+    m_stats.outage.add(record.outage_ns);
+    m_stats.attempts += record.attempts;
+
+    m_state.store(RecoveryState::Online, std::memory_order_release);
+    return record;
+}
+
+void DeviceRecovery::stop()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void DeviceRecovery::run()
+{
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        switch (m_state.load(std::memory_order_acquire))
+        {
+        case RecoveryState::Online:
+            check_connected();
+            break;
+
+        case RecoveryState::Recovering:
+            recover();
+            break;
+
+        case RecoveryState::Recovered:
+        case RecoveryState::Failed:
+            break;
+        }
+
+        sleep_until_ns(mono_now_ns() + m_tuning.poll_ns);
+    }
+}
+
+// A request that waited too long would overlap the next edge, it is dropped
+void DeviceRecovery::check_connected()
+{
+    const int64_t asked_ns = m_probe_request_ns.exchange(0, std::memory_order_acquire);
+    if (!asked_ns)
+        return;
+
+    const int64_t now_ns = mono_now_ns();
+    if (now_ns - asked_ns > m_tuning.probe_window_ns || now_ns - m_probed_ns < m_tuning.probe_ns)
+        return;
+
+    m_probed_ns = now_ns;
+    if (m_calls.connect(m_dds.device()) == HT_OK)
+        return;
+
+    m_failed_ns.store(now_ns, std::memory_order_relaxed);
+
+    RecoveryState online = RecoveryState::Online;
+    m_state.compare_exchange_strong(online, RecoveryState::Recovering, std::memory_order_acq_rel);
+}
+
+void DeviceRecovery::recover()
+{
+    const WORD dev = m_dds.device();
+    const int64_t failed_ns = m_failed_ns.load(std::memory_order_relaxed);
+
+    m_ready_ns = 0;
+    m_attempts = 0;
+
+    while (!m_stop.load(std::memory_order_relaxed) && mono_now_ns() - failed_ns < m_tuning.give_up_ns)
+    {
+        ++m_attempts;
+
+        if (m_calls.connect(dev) == HT_OK && m_calls.init_hard(dev) == HT_OK)
+        {
+            // Whatever the cache believes was lost with the device
+            m_dds.invalidate();
+
+            // The ddsSDKSet* calls return register values, only the frequency
+            // (0 when nothing was achieved) and the switch on tell a failure
+            m_dds.set_wave_type(m_setup.wave_type);
+            const bool tuned = m_dds.set_frequency(m_setup.frequency_hz) > 0.0f;
+            m_dds.set_amplitude(m_setup.amplitude_mv);
+            m_dds.set_offset(m_setup.offset_mv);
+
+            if (tuned && m_dds.set_on_off(true) == HT_OK)
+            {
+                m_ready_ns = mono_now_ns();
+                m_state.store(RecoveryState::Recovered, std::memory_order_release);
+                return;
+            }
+
+            // Dropped again half way, nothing it wrote can be trusted
+            m_dds.invalidate();
+        }
+
+        sleep_until_ns(mono_now_ns() + m_tuning.retry_ns);
+    }
+
+    m_state.store(RecoveryState::Failed, std::memory_order_release);
+}
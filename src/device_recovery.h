@@ -0,0 +1,129 @@
+#ifndef DEVICE_RECOVERY_H
+#define DEVICE_RECOVERY_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "dds_state.h"
+#include "edge_scheduler.h"
+#include "hantek_sdk.h"
+
+//------------------------------------------------------------------------------
+
+struct RecoveryCalls
+{
+    PFN_dsoHTDeviceConnect connect;
+    PFN_dsoInitHard        init_hard;
+};
+
+struct RecoveryTuning
+{
+    int64_t retry_ns        = 250000000;     // between reconnect attempts
+    int64_t probe_ns        = 1000000000;    // between dsoHTDeviceConnect checks while online
+    int64_t probe_window_ns = 200000000;     // a probe request older than this is skipped
+    int64_t poll_ns         = 20000000;      // recovery thread's wake-up period while idle
+    int64_t give_up_ns      = 120000000000;  // outage after which the transmitter stops
+};
+
+// Generator state restored after a reconnect: carrier on at full amplitude
+struct DdsSetup
+{
+    WORD  wave_type;
+    float frequency_hz;
+    WORD  amplitude_mv;
+    short offset_mv;
+};
+
+enum class RecoveryState : uint8_t
+{
+    Online,
+    Recovering,     // the recovery thread owns the device
+    Recovered,      // set up again, waiting for the transmit thread to resume
+    Failed,         // gave up
+};
+
+// One finished outage
+struct OutageRecord
+{
+    int64_t  recovery_ns;   // loss noticed -> device connected, initialised and set up
+    int64_t  outage_ns;     // loss noticed -> first edge played again
+    uint32_t attempts;      // dsoHTDeviceConnect calls
+};
+
+struct OutageStats
+{
+    EdgeLatenessStats recovery;
+    EdgeLatenessStats outage;
+    uint64_t attempts = 0;
+};
+
+//------------------------------------------------------------------------------
+
+// Brings a device back after it dropped off USB. The transmit thread calls
+// begin() when a status returning SDK call fails, or probe() in the quiet part
+// of a second (ddsSDKSetAmp returns a register value, not a status, so the
+// edges themselves cannot tell). Both only touch atomics: a background thread
+// runs the dsoHTDeviceConnect liveness check, and on a failure retries
+// dsoHTDeviceConnect / dsoInitHard and restores the DDS setup through the
+// state cache (invalidated, the registers are lost with the device). The
+// transmit thread keeps walking its schedule without touching the device and
+// calls resume() on the first edge after the state turned Recovered.
+//
+// The background thread runs from construction to stop(). Construct before
+// raising the transmit thread's priority so it does not inherit it.
+class DeviceRecovery
+{
+public:
+    DeviceRecovery(DdsStateCache &dds, const RecoveryCalls &calls, const DdsSetup &setup,
+                   const RecoveryTuning &tuning = RecoveryTuning());
+    ~DeviceRecovery();
+
+    RecoveryState state() const { return m_state.load(std::memory_order_acquire); }
+
+    // Transmit thread, Online only: the device is the recovery thread's now
+    void begin(int64_t failed_ns);
+
+    // Transmit thread, Online only, after the last call of a second: asks the
+    // recovery thread to check within probe_window_ns, at most once per
+    // probe_ns, that the device is still connected. A device found gone turns
+    // the state Recovering.
+    void probe(int64_t now_ns);
+
+    // Transmit thread, Recovered only: back Online, closes the outage at now_ns
+    OutageRecord resume(int64_t now_ns);
+
+    // End of transmission: abandons a recovery in progress, the state is then
+    // Recovered or Failed. The device is the caller's again.
+    void stop();
+
+    // Finished outages, read from the transmit thread
+    const OutageStats &stats() const { return m_stats; }
+
+private:
+    void run();
+    void check_connected();
+    void recover();
+
+    DdsStateCache &m_dds;
+    const RecoveryCalls m_calls;
+    const DdsSetup m_setup;
+    const RecoveryTuning m_tuning;
+
+    std::atomic<RecoveryState> m_state{RecoveryState::Online};
+    std::atomic<bool> m_stop{false};
+    std::atomic<int64_t> m_failed_ns{0};        // written before the switch to Recovering
+    std::atomic<int64_t> m_probe_request_ns{0}; // 0 when no probe is asked for
+    std::thread m_thread;
+
+    int64_t  m_probe_asked_ns = 0;              // transmit thread only
+    int64_t  m_probed_ns      = 0;              // recovery thread only
+
+    // Written by the recovery thread before it publishes Recovered / Failed
+    int64_t  m_ready_ns  = 0;
+    uint32_t m_attempts  = 0;
+
+    OutageStats m_stats;
+};
+
+#endif // DEVICE_RECOVERY_H
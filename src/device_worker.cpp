@@ -0,0 +1,124 @@
+#include "device_worker.h"
+
+#include "device_recovery.h"
+#include "mono_clock.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+// Idle poll of the command queue. Commands are submitted well ahead of their
+// due time, the precise wait happens in sleep_until_ns().
+const int64_t DEVICE_POLL_NS = 1 * NS_PER_MS;
+
+//------------------------------------------------------------------------------
+
+WORD device_command_execute(DdsStateCache &dds, DeviceCommandKind kind, uint32_t value)
+{
+    switch (kind)
+    {
+    case DeviceCommandKind::SetAmplitude:
+        dds.set_amplitude(static_cast<WORD>(value));
+        return HT_OK;
+    case DeviceCommandKind::SetWaveType:
+        dds.set_wave_type(static_cast<WORD>(value));
+        return HT_OK;
+    case DeviceCommandKind::SetOnOff:
+        return dds.set_on_off(value != 0) == HT_OK ? HT_OK : 0;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+DeviceWorker::DeviceWorker(DdsStateCache &dds, const DeviceRecovery *recovery)
+    : m_dds(dds), m_recovery(recovery)
+{
+}
+
+DeviceWorker::~DeviceWorker()
+{
+    stop();
+}
+
+void DeviceWorker::start(const RtThreadConfig &rt)
+{
+    m_running.store(true, std::memory_order_relaxed);
+    m_thread = std::thread(&DeviceWorker::run, this, rt);
+}
+
+// Commands still queued are dropped
+void DeviceWorker::stop()
+{
+    m_running.store(false, std::memory_order_relaxed);
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool DeviceWorker::submit(DeviceCommandKind kind, uint32_t value, int64_t due_ns, uint64_t &seq)
+{
+    const DeviceCommand command = {m_next_seq, due_ns, kind, value};
+    if (!m_commands.try_push(command))
+        return false;
+
+    seq = m_next_seq++;
+    return true;
+}
+
+bool DeviceWorker::wait(DeviceCompletion &completion, int64_t timeout_ns)
+{
+    const int64_t give_up_ns = mono_now_ns() + timeout_ns;
+
+    while (!m_completions.try_pop(completion))
+    {
+        if (mono_now_ns() >= give_up_ns)
+            return false;
+
+        sleep_until_ns(mono_now_ns() + DEVICE_POLL_NS);
+    }
+
+    return true;
+}
+
+void DeviceWorker::run(RtThreadConfig rt)
+{
+    rt_configure_current_thread(rt);
+
+    DeviceCommand command;
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        if (!m_commands.try_pop(command))
+        {
+            sleep_until_ns(mono_now_ns() + DEVICE_POLL_NS);
+            continue;
+        }
+
+        sleep_until_ns(command.due_ns);
+
+        // Sized like the command queue, the producer waits for every completion
+        m_completions.try_push(execute(command));
+    }
+}
+
+DeviceCompletion DeviceWorker::execute(const DeviceCommand &command)
+{
+    DeviceCompletion completion = {command.seq, command.kind, false, false, 0, command.due_ns, 0, 0, 0};
+
+    if (m_recovery && m_recovery->state() != RecoveryState::Online)
+    {
+        completion.skipped = true;
+        return completion;
+    }
+
+    const uint64_t issued = m_dds.stats().issued;
+
+    completion.call_ns     = mono_now_ns();
+    completion.call_utc_ns = utc_now_ns();
+
+    completion.rc = device_command_execute(m_dds, command.kind, command.value);
+
+    completion.done_ns = mono_now_ns();
+    completion.sent    = m_dds.stats().issued != issued;
+    return completion;
+}
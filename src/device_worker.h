@@ -0,0 +1,93 @@
+#ifndef DEVICE_WORKER_H
+#define DEVICE_WORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "dds_state.h"
+#include "rt_thread.h"
+#include "spsc_ring.h"
+
+//------------------------------------------------------------------------------
+
+const size_t DEVICE_QUEUE_CAPACITY = 64;    // a few seconds of edges
+
+enum class DeviceCommandKind : uint8_t
+{
+    SetAmplitude,
+    SetWaveType,
+    SetOnOff,
+};
+
+struct DeviceCommand
+{
+    uint64_t seq;
+    int64_t  due_ns;    // monotonic time the call is issued at
+    DeviceCommandKind kind;
+    uint32_t value;
+};
+
+struct DeviceCompletion
+{
+    uint64_t seq;
+    DeviceCommandKind kind;
+    bool     sent;      // false if the state cache dropped the write
+    bool     skipped;   // not issued, the device was being reconnected
+    uint32_t rc;        // status, see device_command_execute
+    int64_t  due_ns;
+    int64_t  call_ns;   // call entered
+    int64_t  call_utc_ns;   // ... on the system clock, sampled right after call_ns
+    int64_t  done_ns;   // call returned
+};
+
+// Issue one command through the cache on the calling thread. Returns a status:
+// ddsSetOnOff's own, HT_OK for the setters that return a register value.
+WORD device_command_execute(DdsStateCache &dds, DeviceCommandKind kind, uint32_t value);
+
+class DeviceRecovery;
+
+//------------------------------------------------------------------------------
+
+// Owns the device while running: one thread takes timestamped commands from
+// an SPSC queue, sleeps until each is due, issues it through the DDS state
+// cache and queues a completion with the rc and the measured call times.
+// Commands run in submission order, so due times must not decrease.
+//
+// With a recovery, a command that comes due while it is not Online completes
+// as skipped: the device is the recovery thread's then.
+//
+// The producer must not touch the cache between start() and stop().
+class DeviceWorker
+{
+public:
+    explicit DeviceWorker(DdsStateCache &dds, const DeviceRecovery *recovery = nullptr);
+    ~DeviceWorker();
+
+    void start(const RtThreadConfig &rt);
+    void stop();
+
+    // False when the queue is full
+    bool submit(DeviceCommandKind kind, uint32_t value, int64_t due_ns, uint64_t &seq);
+
+    bool poll(DeviceCompletion &completion) { return m_completions.try_pop(completion); }
+
+    // Poll until the next completion arrives or timeout_ns passes
+    bool wait(DeviceCompletion &completion, int64_t timeout_ns);
+
+private:
+    void run(RtThreadConfig rt);
+    DeviceCompletion execute(const DeviceCommand &command);
+
+    DdsStateCache &m_dds;
+    const DeviceRecovery *m_recovery;
+
+    SpscRing<DeviceCommand, DEVICE_QUEUE_CAPACITY>    m_commands;
+    SpscRing<DeviceCompletion, DEVICE_QUEUE_CAPACITY> m_completions;
+
+    uint64_t m_next_seq = 0;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+};
+
+#endif // DEVICE_WORKER_H
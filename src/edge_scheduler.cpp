@@ -0,0 +1,100 @@
+#include "edge_scheduler.h"
+
+#include "mono_clock.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+void EdgeLatenessStats::reset()
+{
+    *this = EdgeLatenessStats();
+}
+
+void EdgeLatenessStats::add(int64_t lateness_ns)
+{
+    if (count == 0 || lateness_ns < min_ns)
+        min_ns = lateness_ns;
+    if (count == 0 || lateness_ns > max_ns)
+        max_ns = lateness_ns;
+
+    last_ns = lateness_ns;
+    sum_ns += lateness_ns;
+    ++count;
+}
+
+int64_t EdgeLatenessStats::mean_ns() const
+{
+    return count ? sum_ns / static_cast<int64_t>(count) : 0;
+}
+
+//------------------------------------------------------------------------------
+
+EdgeScheduler::EdgeScheduler(int64_t epoch_ns)
+    : m_epoch_ns(epoch_ns)
+{
+}
+
+void EdgeScheduler::lock_to_utc(int64_t utc_epoch_ns)
+{
+    m_utc_locked   = true;
+    m_utc_epoch_ns = utc_epoch_ns;
+    resync();
+}
+
+void EdgeScheduler::resync()
+{
+    if (!m_utc_locked)
+        return;
+
+    m_utc_minus_mono_ns = sample_utc_mono_offset().utc_minus_mono_ns;
+    m_epoch_ns          = m_utc_epoch_ns - m_utc_minus_mono_ns;
+}
+
+void EdgeScheduler::begin_minute()
+{
+    m_minute.reset();
+    m_minute_phase.reset();
+}
+
+int64_t EdgeScheduler::deadline_ns(uint64_t second, uint32_t offset_ms) const
+{
+    return m_epoch_ns + static_cast<int64_t>(second) * NS_PER_S + static_cast<int64_t>(offset_ms) * NS_PER_MS;
+}
+
+int64_t EdgeScheduler::wait_until(int64_t deadline_ns)
+{
+    sleep_until_ns(deadline_ns);
+
+    const int64_t lateness_ns = mono_now_ns() - deadline_ns;
+
+    m_minute.add(lateness_ns);
+    m_total.add(lateness_ns);
+
+    if (m_utc_locked)
+    {
+        const int64_t phase_ns = utc_now_ns() - (deadline_ns + m_utc_minus_mono_ns);
+
+        m_minute_phase.add(phase_ns);
+        m_total_phase.add(phase_ns);
+    }
+
+    return lateness_ns;
+}
+
+int64_t EdgeScheduler::record_wait(int64_t deadline_ns, int64_t woke_ns, int64_t woke_utc_ns)
+{
+    const int64_t lateness_ns = woke_ns - deadline_ns;
+
+    m_minute.add(lateness_ns);
+    m_total.add(lateness_ns);
+
+    if (m_utc_locked)
+    {
+        const int64_t phase_ns = woke_utc_ns - (deadline_ns + m_utc_minus_mono_ns);
+
+        m_minute_phase.add(phase_ns);
+        m_total_phase.add(phase_ns);
+    }
+
+    return lateness_ns;
+}
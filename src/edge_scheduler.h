@@ -0,0 +1,83 @@
+#ifndef EDGE_SCHEDULER_H
+#define EDGE_SCHEDULER_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+struct EdgeLatenessStats
+{
+    uint64_t count  = 0;
+    int64_t  last_ns = 0;
+    int64_t  min_ns  = 0;
+    int64_t  max_ns  = 0;
+    int64_t  sum_ns  = 0;
+
+    void reset();
+    void add(int64_t lateness_ns);
+    int64_t mean_ns() const;
+};
+
+//------------------------------------------------------------------------------
+
+// Schedules amplitude edges as absolute deadlines on the monotonic clock.
+// Every deadline is derived from a fixed epoch and the second index, so a late
+// edge never shifts the following ones and no drift builds up across minutes.
+//
+// Once locked to UTC the epoch follows the system clock: resync() re-samples
+// the UTC - monotonic offset and every recorded edge also gets its phase error
+// against the UTC instant it was meant for.
+class EdgeScheduler
+{
+public:
+    explicit EdgeScheduler(int64_t epoch_ns);
+
+    int64_t epoch_ns() const { return m_epoch_ns; }
+
+    // Anchor second 0 to the given UTC instant (ns since 1970)
+    void lock_to_utc(int64_t utc_epoch_ns);
+
+    // Refresh the UTC - monotonic offset, no-op when not locked to UTC
+    void resync();
+
+    bool utc_locked() const { return m_utc_locked; }
+
+    // Absolute deadline of an edge offset_ms into the given second since epoch
+    int64_t deadline_ns(uint64_t second, uint32_t offset_ms) const;
+
+    // Absolute deadline of an offset from the start of second 0
+    int64_t epoch_deadline_ns(int64_t since_epoch_ns) const { return m_epoch_ns + since_epoch_ns; }
+
+    // Monotonic time on the deadline timescale, second k starts at k s (UTC when locked)
+    int64_t since_epoch_ns(int64_t mono_ns) const { return mono_ns - m_epoch_ns; }
+
+    // Sleep until deadline_ns, returns and records the wake-up lateness
+    int64_t wait_until(int64_t deadline_ns);
+
+    // Record a wait another thread did: woke_ns is when it returned, woke_utc_ns
+    // the system clock sampled there for the UTC phase
+    int64_t record_wait(int64_t deadline_ns, int64_t woke_ns, int64_t woke_utc_ns);
+
+    void begin_minute();
+
+    const EdgeLatenessStats &minute_stats() const { return m_minute; }
+    const EdgeLatenessStats &total_stats() const { return m_total; }
+
+    // UTC phase error of the issued edges, only filled when locked to UTC
+    const EdgeLatenessStats &minute_phase_stats() const { return m_minute_phase; }
+    const EdgeLatenessStats &total_phase_stats() const { return m_total_phase; }
+
+private:
+    int64_t m_epoch_ns;
+
+    bool    m_utc_locked = false;
+    int64_t m_utc_epoch_ns = 0;
+    int64_t m_utc_minus_mono_ns = 0;
+
+    EdgeLatenessStats m_minute;
+    EdgeLatenessStats m_total;
+    EdgeLatenessStats m_minute_phase;
+    EdgeLatenessStats m_total_phase;
+};
+
+#endif // EDGE_SCHEDULER_H
@@ -0,0 +1,96 @@
+#ifndef HANTEK_SDK_H
+#define HANTEK_SDK_H
+
+// Function signatures of the HTHardDll.dll entry points the transmitter uses.
+// A backend is anything that provides functions with these signatures: the
+// real DLL (Windows only) or the simulated device in hantek_sim.h.
+
+#include <cstddef>
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#ifdef DLL_API
+#undef DLL_API
+#endif
+#define DLL_API extern "C" __declspec(dllimport)
+
+#include "DefMacro.h"
+#include "HTSoftDll.h"
+#include "HTHardDll.h"
+#include "MeasDll.h"
+
+#else
+
+// The SDK headers need windows.h, only the types and values used here are repeated
+typedef unsigned short WORD;
+typedef unsigned short USHORT;
+typedef unsigned long  ULONG;
+typedef unsigned long *PULONG;
+typedef unsigned char  UCHAR;
+typedef int            BOOL;
+
+#define WINAPI
+
+// DefMacro.h
+#define WAVE_SINE   0
+#define WAVE_AM     6
+#define HT_OK       1
+
+#endif
+
+//------------------------------------------------------------------------------
+
+const WORD   DEVICE_SLOTS   = 32;   // USB slots reported by dsoHTSearchDevice
+const size_t DEVICE_SN_MAX  = 64;   // dsoGetDeviceSN / dsoGetDeviceName buffer, the SDK does not state a size
+
+// Scope / hardware
+typedef WORD (WINAPI *PFN_dsoHTSearchDevice)(short *pDevInfo);
+typedef WORD (WINAPI *PFN_dsoHTDeviceConnect)(WORD nDeviceIndex);
+typedef WORD (WINAPI *PFN_dsoInitHard)(WORD nDeviceIndex);
+typedef BOOL (WINAPI *PFN_dsoGetDeviceName)(WORD nDeviceIndex, UCHAR *pBuffer);
+typedef BOOL (WINAPI *PFN_dsoGetDeviceSN)(WORD nDeviceIndex, UCHAR *pBuffer);
+typedef WORD (WINAPI *PFN_dsoGetFPGAVersion)(WORD nDeviceIndex);
+typedef WORD (WINAPI *PFN_dsoHTSetHardFC)(WORD nDeviceIndex, ULONG nTime, WORD nCountSet);
+typedef WORD (WINAPI *PFN_dsoHTGetHardFC)(WORD nDeviceIndex, PULONG pFreq, PULONG pCount);
+
+// DDS / generator. The ddsSDKSet* setters return a register value, not a
+// status; ddsSDKSetFre's is the frequency the DDS achieved.
+typedef WORD (WINAPI *PFN_ddsSDKSetWaveType)(WORD nDeviceIndex, WORD nWaveType);
+typedef float (WINAPI *PFN_ddsSDKSetFre)(WORD nDeviceIndex, float fFre);
+typedef WORD (WINAPI *PFN_ddsSDKSetAmp)(WORD nDeviceIndex, WORD nAmp);
+typedef short (WINAPI *PFN_ddsSDKSetOffset)(WORD nDeviceIndex, short nOffset);
+typedef ULONG (WINAPI *PFN_ddsSetOnOff)(WORD nDeviceIndex, short nOnOff);
+typedef ULONG (WINAPI *PFN_ddsSetCmd)(WORD nDeviceIndex, USHORT nControl);
+typedef WORD (WINAPI *PFN_ddsSDKSetBurstNum)(WORD nDeviceIndex, WORD nBurstNum);
+typedef ULONG (WINAPI *PFN_ddsEmitSingle)(WORD nDeviceIndex);
+typedef WORD (WINAPI *PFN_ddsSetFAOC)(WORD nDeviceIndex, double dFre, WORD nAmpVolt, short nOffsetVolt, ULONG nPeriodNum,
+                                      float fAMDepth, double dbFMMAXOffset);
+typedef ULONG (WINAPI *PFN_ddsSetAMFMFreq)(WORD nDeviceIndex, double dbFre);
+
+//------------------------------------------------------------------------------
+
+// The entry points above as X(name, required). Required ones are checked when
+// the DLL is loaded, a missing optional one only disables the feature using it.
+#define SDK_USED_EXPORTS(X)             \
+    X(dsoHTSearchDevice,  true)         \
+    X(dsoHTDeviceConnect, true)         \
+    X(dsoInitHard,        true)         \
+    X(dsoGetDeviceName,   false)        \
+    X(dsoGetDeviceSN,     false)        \
+    X(dsoGetFPGAVersion,  false)        \
+    X(dsoHTSetHardFC,     false)        \
+    X(dsoHTGetHardFC,     false)        \
+    X(ddsSDKSetWaveType,  true)         \
+    X(ddsSDKSetFre,       true)         \
+    X(ddsSDKSetAmp,       true)         \
+    X(ddsSDKSetOffset,    true)         \
+    X(ddsSetOnOff,        true)         \
+    X(ddsSetCmd,          false)        \
+    X(ddsSDKSetBurstNum,  false)        \
+    X(ddsEmitSingle,      false)        \
+    X(ddsSetFAOC,         false)        \
+    X(ddsSetAMFMFreq,     false)
+
+#endif // HANTEK_SDK_H
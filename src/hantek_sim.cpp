@@ -0,0 +1,495 @@
+#include "hantek_sim.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "edge_scheduler.h"
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+// Start-to-start intervals longer than this span the minute marker
+const int64_t SIM_MAX_PERIOD_NS  = 1500 * NS_PER_MS;
+
+// Frequency resolution of the DDS, 200 MHz clock into a 32-bit phase accumulator
+const double SIM_DDS_STEP_HZ     = 200e6 / 4294967296.0;
+
+// Registers of the DDS and the output they produced
+struct SimOutputChange
+{
+    int64_t at_ns;
+    double  amplitude_mv;
+};
+
+struct SimState
+{
+    std::mt19937 rng;
+    std::vector<SimCommand> commands;
+    std::vector<SimOutputChange> output;
+    uint64_t dropped = 0;
+
+    bool    on             = false;
+    bool    burst_mode     = false;
+    double  amplitude_mv   = 0.0;
+    WORD    wave_type      = WAVE_SINE;
+    double  am_depth       = 0.0;
+    double  carrier_hz     = 0.0;
+    short   offset_mv      = 0;
+    WORD    burst_cycles   = 0;
+    int64_t burst_end_ns   = 0;     // 0 when no burst is playing
+    ULONG   counter_gate_ns = 0;
+    double  output_mv      = 0.0;
+    bool    disconnected   = false; // the disconnect window was applied
+    bool    needs_init     = false; // registers lost, DDS calls fail until dsoInitHard
+};
+
+static SimConfig g_config;
+static SimState g_devices[DEVICE_SLOTS];
+static int64_t g_configured_ns = 0;
+
+//------------------------------------------------------------------------------
+
+void sim_configure(const SimConfig &config)
+{
+    g_config = config;
+    g_configured_ns = mono_now_ns();
+
+    for (WORD i = 0; i < DEVICE_SLOTS; ++i)
+    {
+        SimState &sim = g_devices[i];
+        sim = SimState();
+        sim.rng.seed(config.seed + i);
+
+        // Recording memory only for the present devices
+        if (i < config.devices)
+        {
+            sim.commands.reserve(SIM_MAX_COMMANDS);
+            sim.output.reserve(SIM_MAX_COMMANDS);
+        }
+    }
+}
+
+uint64_t sim_command_count(WORD device)
+{
+    return g_devices[device].commands.size();
+}
+
+const SimCommand &sim_command(uint64_t index, WORD device)
+{
+    return g_devices[device].commands[index];
+}
+
+static bool sim_present(WORD nDeviceIndex)
+{
+    return nDeviceIndex < g_config.devices;
+}
+
+static void set_output(SimState &sim, int64_t at_ns, double amplitude_mv)
+{
+    if (amplitude_mv == sim.output_mv)
+        return;
+
+    sim.output_mv = amplitude_mv;
+
+    if (sim.output.size() < sim.output.capacity())
+        sim.output.push_back({at_ns, amplitude_mv});
+}
+
+// Level of the output outside a burst: the continuous carrier, or idle in burst
+// mode. AM output is modelled at the envelope trough as --am assumes; what real
+// hardware outputs with a 0 Hz modulator is unverified, its phase is undefined.
+static double register_output_mv(const SimState &sim)
+{
+    if (!sim.on || sim.burst_mode)
+        return 0.0;
+
+    return sim.wave_type == WAVE_AM ? sim.amplitude_mv * (1.0 - sim.am_depth) : sim.amplitude_mv;
+}
+
+// Finish a burst that ended before at_ns, the output then follows the registers
+static void settle_burst(SimState &sim, int64_t at_ns)
+{
+    if (sim.burst_end_ns && sim.burst_end_ns <= at_ns)
+    {
+        set_output(sim, sim.burst_end_ns, register_output_mv(sim));
+        sim.burst_end_ns = 0;
+    }
+}
+
+// Register write that took effect at effect_ns, deferred while a burst plays.
+// The burst must already be settled up to effect_ns. Latching at burst
+// boundaries is what --burst assumes, the real DDS is not known to do it.
+static void apply_registers(SimState &sim, int64_t effect_ns)
+{
+    // Entering burst mode keeps the current level until the first trigger
+    if (!sim.burst_end_ns && !sim.burst_mode)
+        set_output(sim, effect_ns, register_output_mv(sim));
+}
+
+// Block like a USB round trip and record when the output changed.
+// Returns the time the command took effect.
+static int64_t simulate_call(SimState &sim, SimCommandKind kind, double value)
+{
+    const SimConfig &config = g_config;
+
+    std::uniform_int_distribution<int64_t> latency(config.latency_min_ns, config.latency_max_ns);
+    const int64_t latency_ns = latency(sim.rng);
+
+    SimCommand command;
+    command.kind        = kind;
+    command.value       = value;
+    command.issue_ns    = mono_now_ns();
+    command.effect_ns   = command.issue_ns + static_cast<int64_t>(static_cast<double>(latency_ns) * config.effect_point);
+    command.complete_ns = command.issue_ns + latency_ns;
+
+    sleep_until_ns(command.complete_ns);
+
+    // Never reallocate on the timing thread
+    if (sim.commands.size() < sim.commands.capacity())
+        sim.commands.push_back(command);
+    else
+        ++sim.dropped;
+
+    return command.effect_ns;
+}
+
+static int64_t disconnect_start_ns()
+{
+    return g_configured_ns + g_config.disconnect_at_ns;
+}
+
+static bool sim_unplugged(int64_t now_ns)
+{
+    return g_config.disconnect_ns && now_ns >= disconnect_start_ns() &&
+           now_ns < disconnect_start_ns() + g_config.disconnect_ns;
+}
+
+// The first call after the unplug instant finds the output gone since then
+// and every register back at its power-on value
+static void apply_disconnect(SimState &sim, int64_t now_ns)
+{
+    if (!g_config.disconnect_ns || sim.disconnected || now_ns < disconnect_start_ns())
+        return;
+
+    settle_burst(sim, disconnect_start_ns());
+    set_output(sim, disconnect_start_ns(), 0.0);
+
+    sim.on              = false;
+    sim.burst_mode      = false;
+    sim.amplitude_mv    = 0.0;
+    sim.wave_type       = WAVE_SINE;
+    sim.am_depth        = 0.0;
+    sim.carrier_hz      = 0.0;
+    sim.offset_mv       = 0;
+    sim.burst_cycles    = 0;
+    sim.burst_end_ns    = 0;
+    sim.counter_gate_ns = 0;
+    sim.disconnected    = true;
+    sim.needs_init      = true;
+}
+
+// Null for an empty slot, or after a USB timeout while the device is unusable
+static SimState *sim_device(WORD nDeviceIndex)
+{
+    if (!sim_present(nDeviceIndex))
+        return nullptr;
+
+    SimState &sim = g_devices[nDeviceIndex];
+    const int64_t now_ns = mono_now_ns();
+
+    apply_disconnect(sim, now_ns);
+    if (sim.needs_init)
+    {
+        sleep_until_ns(now_ns + g_config.latency_max_ns);
+        return nullptr;
+    }
+    return &sim;
+}
+
+static double ns_to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / NS_PER_MS;
+}
+
+static void print_stats(const char *name, const EdgeLatenessStats &stats)
+{
+    std::cout << "  " << name << " min/avg/max " << ns_to_ms(stats.min_ns) << "/" << ns_to_ms(stats.mean_ns()) << "/"
+              << ns_to_ms(stats.max_ns) << " ms (" << stats.count << ")\n";
+}
+
+void sim_print_summary(const PulseLevels &levels, WORD device)
+{
+    SimState &sim = g_devices[device];
+
+    EdgeLatenessStats latency;
+    EdgeLatenessStats bit_0_width;
+    EdgeLatenessStats bit_1_width;
+    EdgeLatenessStats period;
+    uint64_t invalid = 0;
+
+    for (const SimCommand &command : sim.commands)
+        latency.add(command.complete_ns - command.issue_ns);
+
+    settle_burst(sim, INT64_MAX);
+
+    // Envelope detector: reduced while below the midpoint of the two levels
+    const double threshold_mv = (levels.amplitude_high_mv + levels.amplitude_low_mv) / 2.0;
+
+    bool    reduced        = true;
+    int64_t pulse_start_ns = 0;
+    int64_t last_start_ns  = 0;
+
+    for (const SimOutputChange &change : sim.output)
+    {
+        const bool below = change.amplitude_mv < threshold_mv;
+
+        if (below && !reduced)
+        {
+            pulse_start_ns = change.at_ns;
+        }
+        else if (!below && reduced && pulse_start_ns)
+        {
+            const int64_t width_ns = change.at_ns - pulse_start_ns;
+
+            // Only completed pulses, the final switch-off is not a second start
+            if (last_start_ns && pulse_start_ns - last_start_ns < SIM_MAX_PERIOD_NS)
+                period.add(pulse_start_ns - last_start_ns);
+
+            last_start_ns = pulse_start_ns;
+
+            switch (pulse_width_to_bit(width_ns, levels))
+            {
+            case 0:  bit_0_width.add(width_ns); break;
+            case 1:  bit_1_width.add(width_ns); break;
+            default: ++invalid; break;
+            }
+        }
+
+        reduced = below;
+    }
+
+    std::cout << "Simulated device [" << device << "]: " << sim.commands.size() << " commands recorded, " << sim.dropped << " dropped\n";
+    print_stats("SDK call latency", latency);
+    print_stats("bit 0 pulse width", bit_0_width);
+    print_stats("bit 1 pulse width", bit_1_width);
+    print_stats("second period", period);
+    std::cout << "  undecodable pulses " << invalid << "\n";
+}
+
+//------------------------------------------------------------------------------
+
+WORD WINAPI sim_dsoHTSearchDevice(short *pDevInfo)
+{
+    for (WORD i = 0; i < DEVICE_SLOTS; ++i)
+        pDevInfo[i] = sim_present(i) ? 1 : 0;
+
+    return HT_OK;
+}
+
+// Stateless, discovery probes slots concurrently
+WORD WINAPI sim_dsoHTDeviceConnect(WORD nDeviceIndex)
+{
+    sleep_until_ns(mono_now_ns() + g_config.connect_latency_ns);
+    return sim_present(nDeviceIndex) && !sim_unplugged(mono_now_ns()) ? HT_OK : 0;
+}
+
+WORD WINAPI sim_dsoInitHard(WORD nDeviceIndex)
+{
+    if (!sim_present(nDeviceIndex))
+        return 0;
+
+    SimState &sim = g_devices[nDeviceIndex];
+    const int64_t now_ns = mono_now_ns();
+
+    apply_disconnect(sim, now_ns);
+    if (sim_unplugged(now_ns))
+        return 0;
+
+    sim.needs_init = false;
+    return HT_OK;
+}
+
+BOOL WINAPI sim_dsoGetDeviceName(WORD nDeviceIndex, UCHAR *pBuffer)
+{
+    if (!sim_present(nDeviceIndex))
+        return 0;
+
+    std::memcpy(pBuffer, "6074BD", 7);
+    return 1;
+}
+
+BOOL WINAPI sim_dsoGetDeviceSN(WORD nDeviceIndex, UCHAR *pBuffer)
+{
+    if (!sim_present(nDeviceIndex))
+        return 0;
+
+    std::snprintf(reinterpret_cast<char *>(pBuffer), DEVICE_SN_MAX, "SIM6074BD%04u", nDeviceIndex + 1u);
+    return 1;
+}
+
+WORD WINAPI sim_dsoGetFPGAVersion(WORD nDeviceIndex)
+{
+    return sim_present(nDeviceIndex) ? 0x0102 : 0;
+}
+
+WORD WINAPI sim_dsoHTSetHardFC(WORD nDeviceIndex, ULONG nTime, WORD)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    sim->counter_gate_ns = nTime;
+    return HT_OK;
+}
+
+WORD WINAPI sim_dsoHTGetHardFC(WORD nDeviceIndex, PULONG pFreq, PULONG pCount)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim || !sim->counter_gate_ns || !sim->on)
+        return 0;
+
+    // frequency = nIndata * 1e9 / (8 * nTime)
+    const double actual_hz = sim->carrier_hz * (1.0 + g_config.clock_error_ppm * 1e-6);
+    *pFreq  = static_cast<ULONG>(std::llround(actual_hz * 8.0 * sim->counter_gate_ns / NS_PER_S));
+    *pCount = *pFreq;
+    return HT_OK;
+}
+
+WORD WINAPI sim_ddsSDKSetWaveType(WORD nDeviceIndex, WORD nWaveType)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetWaveType, nWaveType);
+    settle_burst(*sim, effect_ns);
+
+    const WORD previous = sim->wave_type;
+    sim->wave_type = nWaveType;
+    apply_registers(*sim, effect_ns);
+    return previous;
+}
+
+float WINAPI sim_ddsSDKSetFre(WORD nDeviceIndex, float fFre)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0.0f;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetFre, fFre);
+    settle_burst(*sim, effect_ns);
+    sim->carrier_hz = std::round(fFre / SIM_DDS_STEP_HZ) * SIM_DDS_STEP_HZ;
+    return static_cast<float>(sim->carrier_hz);
+}
+
+WORD WINAPI sim_ddsSDKSetAmp(WORD nDeviceIndex, WORD nAmp)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetAmp, nAmp);
+    settle_burst(*sim, effect_ns);
+
+    const WORD previous = static_cast<WORD>(sim->amplitude_mv);
+    sim->amplitude_mv = nAmp;
+    apply_registers(*sim, effect_ns);
+    return previous;
+}
+
+short WINAPI sim_ddsSDKSetOffset(WORD nDeviceIndex, short nOffset)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const short previous = sim->offset_mv;
+    sim->offset_mv = nOffset;
+    return previous;
+}
+
+ULONG WINAPI sim_ddsSetOnOff(WORD nDeviceIndex, short nOnOff)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetOnOff, nOnOff);
+    settle_burst(*sim, effect_ns);
+    sim->on = nOnOff != 0;
+    apply_registers(*sim, effect_ns);
+    return HT_OK;
+}
+
+ULONG WINAPI sim_ddsSetCmd(WORD nDeviceIndex, USHORT nControl)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetCmd, nControl);
+    settle_burst(*sim, effect_ns);
+    sim->burst_mode = nControl != 0;
+    apply_registers(*sim, effect_ns);
+    return 1;
+}
+
+WORD WINAPI sim_ddsSDKSetBurstNum(WORD nDeviceIndex, WORD nBurstNum)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    simulate_call(*sim, SimCommandKind::SetBurstNum, nBurstNum);
+
+    const WORD previous = sim->burst_cycles;
+    sim->burst_cycles = nBurstNum;
+    return previous;
+}
+
+ULONG WINAPI sim_ddsEmitSingle(WORD nDeviceIndex)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::EmitSingle, sim->burst_cycles);
+    settle_burst(*sim, effect_ns);
+
+    // Retriggering a running burst, leaving burst mode or a carrier never set are ignored
+    if (!sim->burst_mode || sim->burst_end_ns || !sim->on || sim->carrier_hz <= 0.0)
+        return 0;
+
+    set_output(*sim, effect_ns, sim->amplitude_mv);
+    sim->burst_end_ns = effect_ns + std::llround(sim->burst_cycles * 1e9 / sim->carrier_hz);
+    return 1;
+}
+
+WORD WINAPI sim_ddsSetFAOC(WORD nDeviceIndex, double dFre, WORD nAmpVolt, short, ULONG, float fAMDepth, double)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    const int64_t effect_ns = simulate_call(*sim, SimCommandKind::SetFAOC, fAMDepth);
+    settle_burst(*sim, effect_ns);
+    sim->carrier_hz   = dFre;
+    sim->amplitude_mv = nAmpVolt;
+    sim->am_depth     = fAMDepth;
+    apply_registers(*sim, effect_ns);
+    return HT_OK;
+}
+
+ULONG WINAPI sim_ddsSetAMFMFreq(WORD nDeviceIndex, double dbFre)
+{
+    SimState *sim = sim_device(nDeviceIndex);
+    if (!sim)
+        return 0;
+
+    simulate_call(*sim, SimCommandKind::SetAMFMFreq, dbFre);
+    return 1;
+}
@@ -0,0 +1,98 @@
+#ifndef HANTEK_SIM_H
+#define HANTEK_SIM_H
+
+#include <cstdint>
+
+#include "hantek_sdk.h"
+#include "pulse_program.h"
+
+//------------------------------------------------------------------------------
+
+const uint64_t SIM_MAX_COMMANDS = 1 << 16;    // > 9 hours of edges
+
+struct SimConfig
+{
+    int64_t  latency_min_ns = 1000000;  // every call blocks for a uniform random
+    int64_t  latency_max_ns = 5000000;  // time in [min, max], like a USB round trip
+    double   effect_point   = 0.5;      // fraction of the call after which the output changed
+    double   clock_error_ppm = 12.0;    // DDS reference error seen by the frequency counter
+    uint32_t seed           = 77;
+    uint32_t devices        = 1;        // scopes in slots 0..devices-1
+    int64_t  connect_latency_ns = 250000000;    // dsoHTDeviceConnect, probing a slot
+    int64_t  disconnect_at_ns = 0;      // every device drops off USB this long after sim_configure...
+    int64_t  disconnect_ns    = 0;      // ...for this long, 0 never
+};
+
+enum class SimCommandKind : uint8_t
+{
+    SetOnOff,
+    SetAmp,
+    SetFre,
+    SetWaveType,
+    SetCmd,
+    SetBurstNum,
+    EmitSingle,
+    SetFAOC,
+    SetAMFMFreq,
+};
+
+// One recorded call, times are monotonic ns
+struct SimCommand
+{
+    SimCommandKind kind;
+    double  value;
+    int64_t issue_ns;       // call entered
+    int64_t effect_ns;      // output of the simulated DDS changed
+    int64_t complete_ns;    // call returned
+};
+
+//------------------------------------------------------------------------------
+
+// Simulated 6074BD: SimConfig::devices scopes in slots 0..n-1, each records
+// every DDS command with the time its output would have changed. Calls to one
+// device and the accessors below must not overlap, the recording is not
+// synchronized; different devices may be driven from different threads. The
+// identification calls (connect, name, serial, FPGA version) keep no state
+// and may run concurrently.
+//
+// In burst mode (ddsSetCmd 4) register writes latch at burst boundaries: the
+// output keeps its level until ddsEmitSingle, plays exactly the configured number
+// of carrier cycles and then follows whatever was written during the burst.
+// WAVE_AM outputs the carrier reduced by the ddsSetFAOC depth (modulator at its trough).
+// The other ddsSDKSet* setters return the register's previous value, as the
+// SDK manual describes; ddsSDKSetFre rounds to the tuning step of a 32-bit
+// phase accumulator and returns the achieved frequency. The frequency counter sees the generator
+// output, off by clock_error_ppm.
+// While disconnected every call fails after latency_max_ns, the output is gone
+// and the registers are lost: DDS calls keep failing until dsoInitHard.
+void sim_configure(const SimConfig &config);
+
+uint64_t sim_command_count(WORD device = 0);
+const SimCommand &sim_command(uint64_t index, WORD device = 0);
+
+// Decodes the amplitude the simulated output produced against the expected
+// pulse levels and prints widths and start-to-start periods per bit value
+void sim_print_summary(const PulseLevels &levels, WORD device = 0);
+
+WORD  WINAPI sim_dsoHTSearchDevice(short *pDevInfo);
+WORD  WINAPI sim_dsoHTDeviceConnect(WORD nDeviceIndex);
+WORD  WINAPI sim_dsoInitHard(WORD nDeviceIndex);
+BOOL  WINAPI sim_dsoGetDeviceName(WORD nDeviceIndex, UCHAR *pBuffer);
+BOOL  WINAPI sim_dsoGetDeviceSN(WORD nDeviceIndex, UCHAR *pBuffer);
+WORD  WINAPI sim_dsoGetFPGAVersion(WORD nDeviceIndex);
+WORD  WINAPI sim_dsoHTSetHardFC(WORD nDeviceIndex, ULONG nTime, WORD nCountSet);
+WORD  WINAPI sim_dsoHTGetHardFC(WORD nDeviceIndex, PULONG pFreq, PULONG pCount);
+
+WORD  WINAPI sim_ddsSDKSetWaveType(WORD nDeviceIndex, WORD nWaveType);
+float WINAPI sim_ddsSDKSetFre(WORD nDeviceIndex, float fFre);
+WORD  WINAPI sim_ddsSDKSetAmp(WORD nDeviceIndex, WORD nAmp);
+short WINAPI sim_ddsSDKSetOffset(WORD nDeviceIndex, short nOffset);
+ULONG WINAPI sim_ddsSetOnOff(WORD nDeviceIndex, short nOnOff);
+ULONG WINAPI sim_ddsSetCmd(WORD nDeviceIndex, USHORT nControl);
+WORD  WINAPI sim_ddsSDKSetBurstNum(WORD nDeviceIndex, WORD nBurstNum);
+ULONG WINAPI sim_ddsEmitSingle(WORD nDeviceIndex);
+WORD  WINAPI sim_ddsSetFAOC(WORD nDeviceIndex, double dFre, WORD nAmpVolt, short nOffsetVolt, ULONG nPeriodNum,
+                            float fAMDepth, double dbFMMAXOffset);
+ULONG WINAPI sim_ddsSetAMFMFreq(WORD nDeviceIndex, double dbFre);
+
+#endif // HANTEK_SIM_H
@@ -0,0 +1,124 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+
+static unsigned highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (size_t i = 0; i < BUCKETS; ++i)
+        m_counts[i].store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucket_index(int64_t value_ns)
+{
+    if (value_ns < static_cast<int64_t>(SUB_BUCKETS))
+        return value_ns < 0 ? 0 : static_cast<size_t>(value_ns);
+
+    unsigned exponent = highest_bit(static_cast<uint64_t>(value_ns));
+    if (exponent > MAX_EXPONENT)
+        return BUCKETS - 1;
+
+    const unsigned shift    = exponent - SUB_BUCKET_BITS;
+    const uint64_t mantissa = static_cast<uint64_t>(value_ns) >> shift;   // [SUB_BUCKETS, 2 * SUB_BUCKETS)
+
+    return SUB_BUCKETS + shift * SUB_BUCKETS + static_cast<size_t>(mantissa - SUB_BUCKETS);
+}
+
+int64_t LatencyHistogram::bucket_upper_ns(size_t index)
+{
+    if (index < SUB_BUCKETS)
+        return static_cast<int64_t>(index);
+
+    const size_t shift    = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    const size_t mantissa = (index - SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+
+    return static_cast<int64_t>(((mantissa + 1) << shift) - 1);
+}
+
+void LatencyHistogram::record(int64_t value_ns)
+{
+    // Single writer: plain load + store instead of read-modify-write
+    std::atomic<uint64_t> &bucket = m_counts[bucket_index(value_ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (value_ns > m_max_ns.load(std::memory_order_relaxed))
+        m_max_ns.store(value_ns, std::memory_order_relaxed);
+
+    m_total.store(m_total.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void LatencyHistogram::snapshot(Snapshot &out) const
+{
+    out.total  = m_total.load(std::memory_order_acquire);
+    out.max_ns = m_max_ns.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < BUCKETS; ++i)
+        out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+LatencyPercentiles latency_percentiles(const LatencyHistogram::Snapshot &now,
+                                       const LatencyHistogram::Snapshot *since)
+{
+    LatencyPercentiles result = {0, 0, 0, 0, 0};
+
+    uint64_t count = 0;
+    size_t   top   = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    {
+        const uint64_t n = now.counts[i] - (since ? since->counts[i] : 0);
+        if (n)
+            top = i;
+        count += n;
+    }
+
+    if (count == 0)
+        return result;
+
+    // Smallest bucket whose cumulative count reaches ceil(q * count)
+    const uint64_t target_p50  = (count * 500 + 999) / 1000;
+    const uint64_t target_p99  = (count * 990 + 999) / 1000;
+    const uint64_t target_p999 = (count * 999 + 999) / 1000;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i <= top; ++i)
+    {
+        const uint64_t n = now.counts[i] - (since ? since->counts[i] : 0);
+        if (n == 0)
+            continue;
+
+        const uint64_t before = seen;
+        seen += n;
+
+        const int64_t upper = LatencyHistogram::bucket_upper_ns(i);
+        if (before < target_p50 && seen >= target_p50)
+            result.p50_ns = upper;
+        if (before < target_p99 && seen >= target_p99)
+            result.p99_ns = upper;
+        if (before < target_p999 && seen >= target_p999)
+            result.p999_ns = upper;
+    }
+
+    result.count  = count;
+    result.max_ns = since ? LatencyHistogram::bucket_upper_ns(top) : now.max_ns;
+
+    // A bucket's upper bound can lie above the largest sample it holds
+    result.p50_ns  = std::min(result.p50_ns, result.max_ns);
+    result.p99_ns  = std::min(result.p99_ns, result.max_ns);
+    result.p999_ns = std::min(result.p999_ns, result.max_ns);
+    return result;
+}
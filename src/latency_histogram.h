@@ -0,0 +1,68 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+// HDR-style log-linear histogram of nanosecond latencies: values below 128 ns
+// get exact buckets, above that every power of two is split into 128 linear
+// sub-buckets (< 0.8 % error), up to 2^35 ns (~34 s, larger values clamp).
+// Single writer, any number of readers taking snapshots; record() is a pair of
+// relaxed atomic stores and never allocates or blocks.
+class LatencyHistogram
+{
+public:
+    static const unsigned SUB_BUCKET_BITS = 7;
+    static const unsigned SUB_BUCKETS     = 1u << SUB_BUCKET_BITS;
+    static const unsigned MAX_EXPONENT    = 34;
+    static const size_t   BUCKETS         = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Snapshot
+    {
+        uint64_t counts[BUCKETS];
+        uint64_t total;
+        int64_t  max_ns;
+    };
+
+    LatencyHistogram();
+
+    void record(int64_t value_ns);
+    void snapshot(Snapshot &out) const;
+
+    static size_t bucket_index(int64_t value_ns);
+    static int64_t bucket_upper_ns(size_t index);
+
+private:
+    std::atomic<uint64_t> m_counts[BUCKETS];
+    std::atomic<uint64_t> m_total{0};
+    std::atomic<int64_t>  m_max_ns{0};
+};
+
+struct LatencyPercentiles
+{
+    uint64_t count;
+    int64_t  p50_ns;
+    int64_t  p99_ns;
+    int64_t  p999_ns;
+    int64_t  max_ns;
+};
+
+// Percentiles of everything recorded up to now, or only since an earlier
+// snapshot of the same histogram (max is then the top bucket's upper bound)
+LatencyPercentiles latency_percentiles(const LatencyHistogram::Snapshot &now,
+                                       const LatencyHistogram::Snapshot *since = nullptr);
+
+//------------------------------------------------------------------------------
+
+// Per-edge timing of the transmitter
+struct EdgeTimingHistograms
+{
+    LatencyHistogram lateness;      // SDK call start - the deadline it was scheduled for
+    LatencyHistogram sdk_call;      // SDK call duration
+    LatencyHistogram change_error;  // |predicted output change - planned edge time|
+};
+
+#endif // LATENCY_HISTOGRAM_H
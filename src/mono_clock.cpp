@@ -0,0 +1,146 @@
+#include "mono_clock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// Time left to spin after the waitable timer fired. High resolution timers
+// (Windows 10 1803+) wake within ~0.5 ms, legacy ones up to one system timer
+// tick late on top of that.
+const int64_t SPIN_MARGIN_HIGH_RES_NS = 500 * NS_PER_US;
+const int64_t LEGACY_TICK_DEFAULT_NS  = 15625 * NS_PER_US;     // if the tick cannot be queried
+const ULONG   LEGACY_TICK_WANTED      = 10000;                  // 1 ms in 100 ns units
+
+typedef LONG (NTAPI *NtQueryTimerResolutionProc)(PULONG coarsest, PULONG finest, PULONG current);
+typedef LONG (NTAPI *NtSetTimerResolutionProc)(ULONG desired, BOOLEAN set, PULONG current);
+
+// System timer tick the legacy timer fires on. Raised to 1 ms once for the
+// process, like timeBeginPeriod(1) but through ntdll, which every process has
+// loaded, then read back: the system may grant a different tick.
+static int64_t legacy_timer_tick_ns()
+{
+    static const int64_t tick_ns = []
+    {
+        const HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+        if (!ntdll)
+            return LEGACY_TICK_DEFAULT_NS;
+
+        const NtQueryTimerResolutionProc query =
+            reinterpret_cast<NtQueryTimerResolutionProc>(GetProcAddress(ntdll, "NtQueryTimerResolution"));
+        const NtSetTimerResolutionProc set =
+            reinterpret_cast<NtSetTimerResolutionProc>(GetProcAddress(ntdll, "NtSetTimerResolution"));
+
+        ULONG coarsest = 0, finest = 0, current = 0;
+        if (!query || query(&coarsest, &finest, &current) != 0)
+            return LEGACY_TICK_DEFAULT_NS;
+
+        if (set)
+            set(finest > LEGACY_TICK_WANTED ? finest : LEGACY_TICK_WANTED, TRUE, &current);
+
+        if (query(&coarsest, &finest, &current) != 0 || current == 0)
+            return LEGACY_TICK_DEFAULT_NS;
+        return static_cast<int64_t>(current) * 100;
+    }();
+
+    return tick_ns;
+}
+
+struct WaitableTimer
+{
+    HANDLE handle = nullptr;
+    int64_t spin_margin_ns = SPIN_MARGIN_HIGH_RES_NS;
+
+    WaitableTimer()
+    {
+        handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!handle)
+        {
+            handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            spin_margin_ns = legacy_timer_tick_ns() + SPIN_MARGIN_HIGH_RES_NS;
+        }
+    }
+
+    ~WaitableTimer()
+    {
+        if (handle)
+            CloseHandle(handle);
+    }
+};
+
+static int64_t qpc_frequency()
+{
+    static const int64_t freq = []
+    {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return static_cast<int64_t>(f.QuadPart);
+    }();
+
+    return freq;
+}
+
+int64_t mono_now_ns()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    const int64_t freq  = qpc_frequency();
+    const int64_t ticks = counter.QuadPart;
+
+    // Split to avoid overflowing ticks * 1e9
+    return (ticks / freq) * NS_PER_S + ((ticks % freq) * NS_PER_S) / freq;
+}
+
+void sleep_until_ns(int64_t deadline_ns)
+{
+    static thread_local WaitableTimer timer;
+
+    int64_t remaining_ns = deadline_ns - mono_now_ns();
+
+    if (timer.handle && remaining_ns > timer.spin_margin_ns)
+    {
+        LARGE_INTEGER due;
+        due.QuadPart = -((remaining_ns - timer.spin_margin_ns) / 100); // relative, 100 ns units
+
+        if (SetWaitableTimer(timer.handle, &due, 0, nullptr, nullptr, FALSE))
+            WaitForSingleObject(timer.handle, INFINITE);
+    }
+
+    while (mono_now_ns() < deadline_ns)
+    {
+        YieldProcessor();
+    }
+}
+
+#else
+
+int64_t mono_now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NS_PER_S + ts.tv_nsec;
+}
+
+void sleep_until_ns(int64_t deadline_ns)
+{
+    timespec ts;
+    ts.tv_sec  = static_cast<time_t>(deadline_ns / NS_PER_S);
+    ts.tv_nsec = static_cast<long>(deadline_ns % NS_PER_S);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    {
+    }
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef MONO_CLOCK_H
+#define MONO_CLOCK_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+const int64_t NS_PER_US = 1000;
+const int64_t NS_PER_MS = 1000000;
+const int64_t NS_PER_S  = 1000000000;
+
+//------------------------------------------------------------------------------
+
+// Monotonic time in nanoseconds (QueryPerformanceCounter / CLOCK_MONOTONIC).
+// The origin is arbitrary, only differences and absolute deadlines matter.
+int64_t mono_now_ns();
+
+// Block the calling thread until mono_now_ns() >= deadline_ns.
+// Linux: clock_nanosleep(TIMER_ABSTIME). Windows: high resolution waitable
+// timer followed by a short spin, because the timer only takes relative
+// due times in 100 ns units. Without high resolution timers the system tick
+// is raised to 1 ms and the spin sized from the tick actually granted.
+void sleep_until_ns(int64_t deadline_ns);
+
+#endif // MONO_CLOCK_H
@@ -0,0 +1,75 @@
+#include "period_servo.h"
+
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+static double period_ppm(int64_t interval_ns, uint64_t seconds)
+{
+    if (seconds == 0)
+        return 0.0;
+
+    const double nominal_ns = static_cast<double>(seconds) * NS_PER_S;
+    return (static_cast<double>(interval_ns) - nominal_ns) / nominal_ns * 1e6;
+}
+
+//------------------------------------------------------------------------------
+
+PeriodServo::PeriodServo(const PeriodServoTuning &tuning)
+    : m_tuning(tuning)
+{
+}
+
+void PeriodServo::add_second_start(uint64_t second, int64_t start_ns)
+{
+    if (!m_started)
+    {
+        m_started        = true;
+        m_first_second   = second;
+        m_first_start_ns = start_ns;
+    }
+    else
+    {
+        // The minute marker second has no edge, so intervals may span 2 s
+        m_minute_seconds     += second - m_last_second;
+        m_minute_interval_ns += start_ns - m_last_start_ns;
+    }
+
+    m_last_second   = second;
+    m_last_start_ns = start_ns;
+
+    if (!m_tuning.enabled)
+        return;
+
+    const int64_t phase_ns = start_ns - static_cast<int64_t>(second) * NS_PER_S;
+    const double  integral_ns = m_integral_ns + static_cast<double>(phase_ns);
+
+    double trim_ns = -(m_tuning.kp * static_cast<double>(phase_ns) + m_tuning.ki * integral_ns);
+
+    // Anti-windup: the integral only moves while the trim is not saturated
+    const double limit_ns = static_cast<double>(m_tuning.max_trim_ns);
+    if (trim_ns > limit_ns)
+        trim_ns = limit_ns;
+    else if (trim_ns < -limit_ns)
+        trim_ns = -limit_ns;
+    else
+        m_integral_ns = integral_ns;
+
+    m_trim_ns = static_cast<int64_t>(trim_ns);
+}
+
+void PeriodServo::begin_minute()
+{
+    m_minute_seconds     = 0;
+    m_minute_interval_ns = 0;
+}
+
+double PeriodServo::minute_period_ppm() const
+{
+    return period_ppm(m_minute_interval_ns, m_minute_seconds);
+}
+
+double PeriodServo::total_period_ppm() const
+{
+    return period_ppm(m_last_start_ns - m_first_start_ns, m_last_second - m_first_second);
+}
@@ -0,0 +1,55 @@
+#ifndef PERIOD_SERVO_H
+#define PERIOD_SERVO_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+struct PeriodServoTuning
+{
+    bool    enabled     = true;
+    double  kp          = 0.2;      // share of the last phase error corrected at once
+    double  ki          = 0.02;     // share of the accumulated phase error
+    int64_t max_trim_ns = 5000000;
+};
+
+//------------------------------------------------------------------------------
+
+// Closed loop on the achieved start of every second. Starts are measured on the
+// scheduler's epoch timescale (UTC when locked), so second k should begin at
+// exactly k s. A PI controller turns the start error into a trim that shifts
+// the next second's edges, i.e. lengthens or shortens the preceding silence,
+// which drives the long-run mean start-to-start period to 1.000000 s.
+class PeriodServo
+{
+public:
+    explicit PeriodServo(const PeriodServoTuning &tuning);
+
+    // Offset to add to the next second's edge deadlines
+    int64_t trim_ns() const { return m_trim_ns; }
+
+    void add_second_start(uint64_t second, int64_t start_ns);
+
+    void begin_minute();
+
+    // Mean start-to-start period error over the current minute / the whole run
+    double minute_period_ppm() const;
+    double total_period_ppm() const;
+
+private:
+    PeriodServoTuning m_tuning;
+
+    int64_t m_trim_ns = 0;
+    double  m_integral_ns = 0.0;
+
+    bool     m_started = false;
+    uint64_t m_first_second = 0;
+    int64_t  m_first_start_ns = 0;
+    uint64_t m_last_second = 0;
+    int64_t  m_last_start_ns = 0;
+
+    uint64_t m_minute_seconds = 0;
+    int64_t  m_minute_interval_ns = 0;
+};
+
+#endif // PERIOD_SERVO_H
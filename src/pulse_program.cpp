@@ -0,0 +1,41 @@
+#include "pulse_program.h"
+
+#include "dcf77_frame.h"
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+void compile_pulse_program(uint64_t frame_bits, const PulseLevels &levels, PulseProgram &program)
+{
+    PulseEvent *event = program.events;
+
+    const uint64_t air_bits = dcf77_to_air_order(frame_bits);
+
+    for (uint8_t second = 0; second < 59; ++second)
+    {
+        const uint8_t value    = (air_bits >> second) & 1u;
+        const int64_t start_ns = static_cast<int64_t>(second) * NS_PER_S;
+
+        *event++ = {start_ns, levels.amplitude_low_mv, 1, PULSE_EDGE_START, second, value};
+        *event++ = {start_ns + (value ? levels.bit_1_pulse_ns : levels.bit_0_pulse_ns),
+                    levels.amplitude_high_mv, 1, PULSE_EDGE_END, second, value};
+    }
+
+    *event++ = {59 * NS_PER_S, levels.amplitude_high_mv, 1, PULSE_EDGE_MARKER, 59, 0};
+
+    program.frame_bits = frame_bits;
+    program.count      = static_cast<uint32_t>(event - program.events);
+}
+
+int pulse_width_to_bit(int64_t width_ns, const PulseLevels &levels)
+{
+    // Accept up to half the 0/1 difference around each nominal width
+    const int64_t margin_ns = (levels.bit_1_pulse_ns - levels.bit_0_pulse_ns) / 2;
+
+    if (width_ns > levels.bit_0_pulse_ns - margin_ns && width_ns < levels.bit_0_pulse_ns + margin_ns)
+        return 0;
+    if (width_ns >= levels.bit_1_pulse_ns - margin_ns && width_ns < levels.bit_1_pulse_ns + margin_ns)
+        return 1;
+
+    return -1;
+}
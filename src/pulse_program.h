@@ -0,0 +1,54 @@
+#ifndef PULSE_PROGRAM_H
+#define PULSE_PROGRAM_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+// Two edges per modulated second plus the minute marker
+const uint32_t PULSE_PROGRAM_MAX_EVENTS = 2 * 59 + 1;
+
+enum PulseEdge : uint8_t
+{
+    PULSE_EDGE_START  = 0,  // amplitude reduced, start of the second
+    PULSE_EDGE_END    = 1,  // amplitude restored
+    PULSE_EDGE_MARKER = 2,  // second 59, carrier stays at full amplitude
+};
+
+struct PulseEvent
+{
+    int64_t  offset_ns;     // from the start of second 0 of the minute
+    uint16_t amplitude_mv;
+    uint8_t  on;            // generator output enabled
+    uint8_t  edge;          // PulseEdge
+    uint8_t  second;
+    uint8_t  bit_value;
+};
+
+struct PulseLevels
+{
+    uint16_t amplitude_high_mv;
+    uint16_t amplitude_low_mv;
+    int64_t  bit_0_pulse_ns;
+    int64_t  bit_1_pulse_ns;
+};
+
+// One minute of amplitude keying, events sorted by offset_ns
+struct PulseProgram
+{
+    uint64_t   frame_bits;
+    uint32_t   count;
+    PulseEvent events[PULSE_PROGRAM_MAX_EVENTS];
+};
+
+//------------------------------------------------------------------------------
+
+// Flatten a frame (TEST_DCF77_FRAME bit layout, frame bit 58 is sent first)
+// into the events of its minute. Whoever plays or checks a minute walks this
+// array: the host timing loop, the burst engine and the simulated device.
+void compile_pulse_program(uint64_t frame_bits, const PulseLevels &levels, PulseProgram &program);
+
+// Bit a receiver decodes from a measured reduction, -1 if it is neither
+int pulse_width_to_bit(int64_t width_ns, const PulseLevels &levels);
+
+#endif // PULSE_PROGRAM_H
@@ -0,0 +1,173 @@
+#include "rt_thread.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+// Minimum working set kept resident, covers the SDK DLLs, histograms and log ring
+const size_t WORKING_SET_MIN_BYTES = 64u << 20;
+const size_t WORKING_SET_MAX_BYTES = 256u << 20;
+
+void rt_configure_current_thread(const RtThreadConfig &config)
+{
+    if (config.elevate)
+    {
+        // REALTIME_PRIORITY_CLASS needs administrator rights and can starve the
+        // USB stack the SDK calls depend on, HIGH is enough for TIME_CRITICAL
+        BOOL ok = SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+        std::cout << "SetPriorityClass rc = " << ok << "\n";
+
+        ok = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+        std::cout << "SetThreadPriority rc = " << ok << "\n";
+    }
+
+    if (config.cpu_mask)
+    {
+        DWORD_PTR previous = SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(config.cpu_mask));
+        std::cout << "SetThreadAffinityMask rc = " << (previous != 0) << "\n";
+    }
+
+    if (config.lock_memory)
+    {
+        BOOL ok = SetProcessWorkingSetSize(GetCurrentProcess(), WORKING_SET_MIN_BYTES, WORKING_SET_MAX_BYTES);
+        std::cout << "SetProcessWorkingSetSize rc = " << ok << "\n";
+    }
+}
+
+RtThreadSaved rt_save_current_thread()
+{
+    // Threads start with the process affinity, there is no getter for a thread's own
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask  = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        process_mask = 0;
+
+    const RtThreadSaved saved = {static_cast<int>(GetPriorityClass(GetCurrentProcess())),
+                                 GetThreadPriority(GetCurrentThread()), static_cast<uint64_t>(process_mask)};
+    return saved;
+}
+
+void rt_restore_current_thread(const RtThreadSaved &saved)
+{
+    if (saved.policy)
+        SetPriorityClass(GetCurrentProcess(), static_cast<DWORD>(saved.policy));
+    if (saved.priority != THREAD_PRIORITY_ERROR_RETURN)
+        SetThreadPriority(GetCurrentThread(), saved.priority);
+    if (saved.cpu_mask)
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(saved.cpu_mask));
+}
+
+#else
+
+const int RT_FIFO_PRIORITY = 40;
+
+// Stack touched once after mlockall so the loop never faults in a new page
+const size_t STACK_PREFAULT_BYTES = 256u << 10;
+
+static void prefault_stack()
+{
+    unsigned char stack[STACK_PREFAULT_BYTES];
+    std::memset(stack, 0, sizeof(stack));
+    __asm__ __volatile__("" : : "r"(stack) : "memory");
+}
+
+void rt_configure_current_thread(const RtThreadConfig &config)
+{
+    if (config.elevate)
+    {
+        // Stay below the kernel's threaded IRQ handlers (50), every SDK call waits on a USB interrupt
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = RT_FIFO_PRIORITY;
+
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        std::cout << "pthread_setschedparam(SCHED_FIFO, " << param.sched_priority << ") rc = " << rc
+                  << (rc ? " (" + std::string(std::strerror(rc)) + ")" : std::string()) << "\n";
+    }
+
+    if (config.cpu_mask)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64; ++cpu)
+        {
+            if (config.cpu_mask & (1ull << cpu))
+                CPU_SET(cpu, &cpus);
+        }
+
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        std::cout << "pthread_setaffinity_np rc = " << rc << "\n";
+    }
+
+    if (config.lock_memory)
+    {
+        int rc = mlockall(MCL_CURRENT | MCL_FUTURE);
+        std::cout << "mlockall rc = " << (rc ? errno : 0) << "\n";
+
+        if (rc == 0)
+            prefault_stack();
+    }
+}
+
+RtThreadSaved rt_save_current_thread()
+{
+    RtThreadSaved saved = {SCHED_OTHER, 0, 0};
+
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    if (pthread_getschedparam(pthread_self(), &saved.policy, &param) == 0)
+        saved.priority = param.sched_priority;
+    else
+        saved.policy = SCHED_OTHER;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0)
+    {
+        for (int cpu = 0; cpu < 64; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &cpus))
+                saved.cpu_mask |= 1ull << cpu;
+        }
+
+        // A mask cannot hold CPUs past 63, leave such an affinity alone
+        if (CPU_COUNT(&cpus) != __builtin_popcountll(saved.cpu_mask))
+            saved.cpu_mask = 0;
+    }
+    return saved;
+}
+
+void rt_restore_current_thread(const RtThreadSaved &saved)
+{
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = saved.priority;
+    pthread_setschedparam(pthread_self(), saved.policy, &param);
+
+    if (saved.cpu_mask)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64; ++cpu)
+        {
+            if (saved.cpu_mask & (1ull << cpu))
+                CPU_SET(cpu, &cpus);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+}
+
+#endif
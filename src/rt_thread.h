@@ -0,0 +1,38 @@
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+struct RtThreadConfig
+{
+    bool     elevate     = true;    // SCHED_FIFO / THREAD_PRIORITY_TIME_CRITICAL
+    bool     lock_memory = true;    // mlockall / enlarged working set
+    uint64_t cpu_mask    = 0;       // 0 keeps the inherited affinity
+};
+
+//------------------------------------------------------------------------------
+
+// Prepare the calling thread for the transmit loop: raise its scheduling
+// priority, pin it to cpu_mask and keep the process memory resident so page
+// faults cannot delay an edge. Every step is best effort, failures (missing
+// privileges) are printed and the thread keeps running at what it got.
+void rt_configure_current_thread(const RtThreadConfig &config);
+
+// Scheduling of the calling thread before rt_configure_current_thread changed
+// it. Memory stays locked, that is process wide and harmless to keep.
+struct RtThreadSaved
+{
+    int      policy;        // scheduling policy / process priority class
+    int      priority;
+    uint64_t cpu_mask;      // 0 if the affinity could not be read
+};
+
+RtThreadSaved rt_save_current_thread();
+
+// Put the calling thread back to what rt_save_current_thread returned, so
+// threads it starts later do not inherit the real-time priority
+void rt_restore_current_thread(const RtThreadSaved &saved);
+
+#endif // RT_THREAD_H
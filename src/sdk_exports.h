@@ -0,0 +1,188 @@
+#ifndef SDK_EXPORTS_H
+#define SDK_EXPORTS_H
+
+// Every function the SDK DLLs export, one X(dll, name) per declaration in
+// HTHardDll.h, HTSoftDll.h and MeasDll.h (HT6004BX_SDK/HeadFiles_UTF8).
+// Maintained by hand from the uncommented DLL_API lines of each header, in
+// header order with duplicates dropped; compare with `grep "^DLL_API"` on the
+// headers after an SDK update.
+
+// HTHardDll.dll, 103 exports
+#define HT_HARD_DLL_EXPORTS(X) \
+    X(HTHardDll, dsoHTSearchDevice)            \
+    X(HTHardDll, dsoHTDeviceConnect)           \
+    X(HTHardDll, dsoHTSetCHPos)                \
+    X(HTHardDll, dsoHTSetCHDirectLeverPos)     \
+    X(HTHardDll, dsoHTSetVTriggerLevel)        \
+    X(HTHardDll, dsoHTSetHTriggerLength)       \
+    X(HTHardDll, dsoHTSetBufferSize)           \
+    X(HTHardDll, dsoHTSetCHAndTrigger)         \
+    X(HTHardDll, dsoHTSetCHAndTriggerDirect)   \
+    X(HTHardDll, dsoHTSetCHAndTriggerVB)       \
+    X(HTHardDll, dsoHTSetTriggerAndSyncOutput) \
+    X(HTHardDll, dsoHTSetSampleRate)           \
+    X(HTHardDll, dsoHTSetSampleRateVi)         \
+    X(HTHardDll, dsoHTInitSDRam)               \
+    X(HTHardDll, dsoHTStartCollectData)        \
+    X(HTHardDll, dsoHTStartTrigger)            \
+    X(HTHardDll, dsoHTForceTrigger)            \
+    X(HTHardDll, dsoHTGetState)                \
+    X(HTHardDll, dsoHTGetPackState)            \
+    X(HTHardDll, dsoHTGetSDRamInit)            \
+    X(HTHardDll, dsoHTGetData)                 \
+    X(HTHardDll, dsoHTGetScanData)             \
+    X(HTHardDll, dsoHTReadCalibrationData)     \
+    X(HTHardDll, dsoHTWriteCalibrationData)    \
+    X(HTHardDll, dsoSDGetData)                 \
+    X(HTHardDll, dsoSDHTGetRollData)           \
+    X(HTHardDll, dsoSDHTGetScanData)           \
+    X(HTHardDll, dsoHTGetRollData)             \
+    X(HTHardDll, dsoHTOpenRollMode)            \
+    X(HTHardDll, dsoHTCloseRollMode)           \
+    X(HTHardDll, dsoHTSetPeakDetect)           \
+    X(HTHardDll, dsoHTClosePeakDetect)         \
+    X(HTHardDll, dsoHTGetHardFC)               \
+    X(HTHardDll, dsoHTSetHardFC)               \
+    X(HTHardDll, dsoHTResetCnter)              \
+    X(HTHardDll, dsoHTStartRoll)               \
+    X(HTHardDll, dsoGetHardVersion)            \
+    X(HTHardDll, dsoUSBModeSetIPAddr)          \
+    X(HTHardDll, dsoUSBModeGetIPAddr)          \
+    X(HTHardDll, dsoOpenLan)                   \
+    X(HTHardDll, dsoOpenWIFIPower)             \
+    X(HTHardDll, dsoResetWIFI)                 \
+    X(HTHardDll, dsoGetFPGAVersion)            \
+    X(HTHardDll, dsoGetUSBModulVersion)        \
+    X(HTHardDll, dsoSetUSBBus)                 \
+    X(HTHardDll, dsoSetSPIBus)                 \
+    X(HTHardDll, dsoSetHardInfo)               \
+    X(HTHardDll, dsoGetHardInfo)               \
+    X(HTHardDll, dsoWriteFlash)                \
+    X(HTHardDll, dsoReadFlash)                 \
+    X(HTHardDll, dsoGetDeviceName)             \
+    X(HTHardDll, dsoGetDeviceSN)               \
+    X(HTHardDll, dsoGetPCBVersion)             \
+    X(HTHardDll, dsoGetDriverVersion)          \
+    X(HTHardDll, dsoGetLANEnable)              \
+    X(HTHardDll, dsoSetLANEnable)              \
+    X(HTHardDll, dsoWriteIIC)                  \
+    X(HTHardDll, ddsSetOnOff)                  \
+    X(HTHardDll, ddsSetFrequency)              \
+    X(HTHardDll, ddsDownload)                  \
+    X(HTHardDll, ddsSetSyncOut)                \
+    X(HTHardDll, ddsSetCmd)                    \
+    X(HTHardDll, ddsEmitSingle)                \
+    X(HTHardDll, ddsSetFAOC)                   \
+    X(HTHardDll, ddsSetSweep)                  \
+    X(HTHardDll, ddsSetAMFMFreq)               \
+    X(HTHardDll, dsoReadIIC)                   \
+    X(HTHardDll, ddsSDKSetFre)                 \
+    X(HTHardDll, ddsSDKSetAmp)                 \
+    X(HTHardDll, ddsSDKSetOffset)              \
+    X(HTHardDll, ddsSDKSetBurstNum)            \
+    X(HTHardDll, ddsSDKSetWaveType)            \
+    X(HTHardDll, ddsSDKSetWavePhase)           \
+    X(HTHardDll, ddsSDKSetWaveDuty)            \
+    X(HTHardDll, dsoHTWRAmpCali)               \
+    X(HTHardDll, dsoHTRDAmpCali)               \
+    X(HTHardDll, dsoHTWRADCCali)               \
+    X(HTHardDll, dsoHTRDADCCali)               \
+    X(HTHardDll, dsoInitHard)                  \
+    X(HTHardDll, dsoHTADCCHModGain)            \
+    X(HTHardDll, dsoHTSetAmpCalibrate)         \
+    X(HTHardDll, dsoHTSetRamAndTrigerControl)  \
+    X(HTHardDll, dsoHTSetTrigerMode)           \
+    X(HTHardDll, dsoHTSetVideoTriger)          \
+    X(HTHardDll, dsoHTSetPulseTriger)          \
+    X(HTHardDll, dsoSetDDSCali)                \
+    X(HTHardDll, dsoGetDDSCali)                \
+    X(HTHardDll, dsoGetInBufferWithoutOpen)    \
+    X(HTHardDll, dsoGetInBuffer)               \
+    X(HTHardDll, dsoSendOutBuffer)             \
+    X(HTHardDll, dsoGetChmod)                  \
+    X(HTHardDll, dsoGetSampleRate)             \
+    X(HTHardDll, dsoHTSetIIC)                  \
+    X(HTHardDll, dsoHTSetSPI)                  \
+    X(HTHardDll, dsoHTSetUart)                 \
+    X(HTHardDll, dsoHTSetLinCan)               \
+    X(HTHardDll, dsoHTSetSeriseData)           \
+    X(HTHardDll, dsoHTSetSeriesTriggerCommon)  \
+    X(HTHardDll, dsoHTGetCanDecode)            \
+    X(HTHardDll, dsoHTGetLinDecode)            \
+    X(HTHardDll, dsoHTGetUartDecode)           \
+    X(HTHardDll, dsoHTGetSPIDecode)            \
+    X(HTHardDll, dsoHTGetIICDecode)
+
+// HTSoftDll.dll, 26 exports
+#define HT_SOFT_DLL_EXPORTS(X) \
+    X(HTSoftDll, dsoSFInsert)             \
+    X(HTSoftDll, dsoSFProcessALTData)     \
+    X(HTSoftDll, dsoSFFindTrigger)        \
+    X(HTSoftDll, dsoSFFindTriggerCopy)    \
+    X(HTSoftDll, dsoSFInsertDataStep)     \
+    X(HTSoftDll, dsoSFInsertDataLine)     \
+    X(HTSoftDll, dsoSFInsertDataSin)      \
+    X(HTSoftDll, dsoSFCalSinSheet)        \
+    X(HTSoftDll, dsoSFGetInsertNum)       \
+    X(HTSoftDll, dsoSFProcessInsertData)  \
+    X(HTSoftDll, dsoSFGetSampleRate)      \
+    X(HTSoftDll, HTPosConvertToScale)     \
+    X(HTSoftDll, HTGetTracePoint)         \
+    X(HTSoftDll, HTGetTracePointIndex)    \
+    X(HTSoftDll, dsoSFMathOperate)        \
+    X(HTSoftDll, dsoSFChooseData)         \
+    X(HTSoftDll, dsoSFGetFFTSrcData)      \
+    X(HTSoftDll, dsoSFGetFFTSa)           \
+    X(HTSoftDll, dsoSFCalPassFailData)    \
+    X(HTSoftDll, dsoSFPassFail)           \
+    X(HTSoftDll, dsoSFProcessALTData4CH)  \
+    X(HTSoftDll, dsoSFGetMiniScopeFFTSa)  \
+    X(HTSoftDll, dsoGetSoftTriggerPos)    \
+    X(HTSoftDll, dsoGetSoftTriggerPosNew) \
+    X(HTSoftDll, dsoAdjustSquareWave)     \
+    X(HTSoftDll, dsoAdjustADC)
+
+// MeasDll.dll, 35 exports
+#define MEAS_DLL_EXPORTS(X) \
+    X(MeasDll, PreMeas)                        \
+    X(MeasDll, FindPeriod)                     \
+    X(MeasDll, CalAverage)                     \
+    X(MeasDll, CalFrequency)                   \
+    X(MeasDll, CalPeriod)                      \
+    X(MeasDll, CalRiseTime)                    \
+    X(MeasDll, CalFallTime)                    \
+    X(MeasDll, CalPDutyCycle)                  \
+    X(MeasDll, CalNDutyCycle)                  \
+    X(MeasDll, CalPPulseWidth)                 \
+    X(MeasDll, CalNPulseWidth)                 \
+    X(MeasDll, CalPDelay12)                    \
+    X(MeasDll, CalNDelay12)                    \
+    X(MeasDll, CalMaxVolt)                     \
+    X(MeasDll, CalMinVolt)                     \
+    X(MeasDll, CalVpp)                         \
+    X(MeasDll, CalTopVolt)                     \
+    X(MeasDll, CalBaseVolt)                    \
+    X(MeasDll, CalMidVolt)                     \
+    X(MeasDll, CalRMS)                         \
+    X(MeasDll, CalCRMS)                        \
+    X(MeasDll, CalAmplitude)                   \
+    X(MeasDll, CalMean)                        \
+    X(MeasDll, CalCMean)                       \
+    X(MeasDll, CalPreShoot)                    \
+    X(MeasDll, CalOverShoot)                   \
+    X(MeasDll, CursorTime)                     \
+    X(MeasDll, CursorFrequency)                \
+    X(MeasDll, CursorVoltage)                  \
+    X(MeasDll, CursorTraceVoltage)             \
+    X(MeasDll, CursorFFTFrequency)             \
+    X(MeasDll, GetMaxMinData)                  \
+    X(MeasDll, GetAutoMotiveMaxMinData)        \
+    X(MeasDll, GetAmpData)                     \
+    X(MeasDll, AMCalSecondaryIgnitionPlugLead)
+
+#define SDK_EXPORTS(X)      \
+    HT_HARD_DLL_EXPORTS(X)  \
+    HT_SOFT_DLL_EXPORTS(X)  \
+    MEAS_DLL_EXPORTS(X)
+
+#endif // SDK_EXPORTS_H
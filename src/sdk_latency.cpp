@@ -0,0 +1,42 @@
+#include "sdk_latency.h"
+
+#include <cmath>
+
+//------------------------------------------------------------------------------
+
+SdkLatencyEstimator::SdkLatencyEstimator(const SdkLatencyTuning &tuning)
+    : m_tuning(tuning)
+{
+}
+
+int64_t SdkLatencyEstimator::lead_ns() const
+{
+    if (!m_tuning.enabled)
+        return 0;
+
+    const int64_t lead_ns = static_cast<int64_t>(m_estimate_ns * m_tuning.effect_point);
+    return lead_ns < m_tuning.max_lead_ns ? lead_ns : m_tuning.max_lead_ns;
+}
+
+int64_t SdkLatencyEstimator::effective_ns(int64_t call_ns, int64_t done_ns) const
+{
+    return call_ns + static_cast<int64_t>(static_cast<double>(done_ns - call_ns) * m_tuning.effect_point);
+}
+
+void SdkLatencyEstimator::add(int64_t duration_ns)
+{
+    const double sample_ns = static_cast<double>(duration_ns);
+
+    // The first sample seeds the estimate, no slow ramp up from zero
+    if (m_count++ == 0)
+    {
+        m_estimate_ns  = sample_ns;
+        m_deviation_ns = 0.0;
+        return;
+    }
+
+    const double error_ns = sample_ns - m_estimate_ns;
+
+    m_estimate_ns  += m_tuning.gain * error_ns;
+    m_deviation_ns += m_tuning.gain * (std::fabs(error_ns) - m_deviation_ns);
+}
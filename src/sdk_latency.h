@@ -0,0 +1,49 @@
+#ifndef SDK_LATENCY_H
+#define SDK_LATENCY_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+struct SdkLatencyTuning
+{
+    bool    enabled      = true;
+    double  gain         = 0.125;       // EWMA weight of a new sample
+    double  effect_point = 0.5;         // fraction of the call after which the amplitude has changed
+    int64_t max_lead_ns  = 10000000;    // never issue a call more than this early
+};
+
+//------------------------------------------------------------------------------
+
+// Moving estimate of the ddsSDKSetAmp round trip, fed from the transmitter's own
+// timestamps around every call. The amplitude is assumed to change effect_point
+// into the call, so issuing the call lead_ns() early puts the predicted change
+// on the deadline instead of the call start.
+class SdkLatencyEstimator
+{
+public:
+    explicit SdkLatencyEstimator(const SdkLatencyTuning &tuning);
+
+    const SdkLatencyTuning &tuning() const { return m_tuning; }
+
+    // How much earlier than the edge deadline the next call should be issued
+    int64_t lead_ns() const;
+
+    // Predicted moment the amplitude changed during a call
+    int64_t effective_ns(int64_t call_ns, int64_t done_ns) const;
+
+    void add(int64_t duration_ns);
+
+    uint64_t count() const { return m_count; }
+    int64_t estimate_ns() const { return static_cast<int64_t>(m_estimate_ns); }
+    int64_t deviation_ns() const { return static_cast<int64_t>(m_deviation_ns); }
+
+private:
+    SdkLatencyTuning m_tuning;
+
+    uint64_t m_count = 0;
+    double   m_estimate_ns = 0.0;
+    double   m_deviation_ns = 0.0;  // EWMA of |sample - estimate|
+};
+
+#endif // SDK_LATENCY_H
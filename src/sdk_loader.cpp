@@ -0,0 +1,153 @@
+#include "sdk_loader.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+enum SlotState : uint8_t
+{
+    SLOT_UNRESOLVED,
+    SLOT_RESOLVED,
+    SLOT_MISSING,
+};
+
+struct ExportEntry
+{
+    SdkDll dll;
+    const char *name;
+};
+
+#define SDK_EXPORT_ENTRY(dll, name) {SdkDll::dll, #name},
+const ExportEntry EXPORTS[SDK_EXPORT_COUNT] = {SDK_EXPORTS(SDK_EXPORT_ENTRY)};
+#undef SDK_EXPORT_ENTRY
+
+const char *const DLL_FILES[SDK_DLL_COUNT] = {"HTHardDll.dll", "HTSoftDll.dll", "MeasDll.dll"};
+
+// Read lock free once resolved, the slow path is serialised
+std::atomic<SdkProc> g_procs[SDK_EXPORT_COUNT];
+std::atomic<uint8_t> g_states[SDK_EXPORT_COUNT];
+std::mutex g_mutex;
+
+SdkLoadStats g_stats;
+
+#ifdef _WIN32
+HMODULE g_dlls[SDK_DLL_COUNT] = {};
+
+bool load_locked(SdkDll dll)
+{
+    const size_t index = static_cast<size_t>(dll);
+    if (g_dlls[index])
+        return true;
+
+    const int64_t start_ns = mono_now_ns();
+    g_dlls[index] = LoadLibraryA(DLL_FILES[index]);
+
+    if (!g_dlls[index])
+    {
+        std::cerr << "Cannot load " << DLL_FILES[index] << ", GetLastError = " << GetLastError() << "\n";
+        return false;
+    }
+
+    g_stats.load_ns[index] = mono_now_ns() - start_ns;
+    return true;
+}
+#endif
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+const char *sdk_dll_file(SdkDll dll)
+{
+    return DLL_FILES[static_cast<size_t>(dll)];
+}
+
+const char *sdk_export_name(SdkExport id)
+{
+    return EXPORTS[static_cast<size_t>(id)].name;
+}
+
+bool sdk_load(SdkDll dll)
+{
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return load_locked(dll);
+#else
+    (void)dll;
+    return false;
+#endif
+}
+
+void sdk_unload()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    for (size_t i = 0; i < SDK_EXPORT_COUNT; ++i)
+    {
+        g_procs[i].store(nullptr, std::memory_order_relaxed);
+        g_states[i].store(SLOT_UNRESOLVED, std::memory_order_relaxed);
+    }
+
+#ifdef _WIN32
+    for (HMODULE &dll : g_dlls)
+    {
+        if (dll)
+            FreeLibrary(dll);
+        dll = nullptr;
+    }
+#endif
+
+    g_stats = SdkLoadStats();
+}
+
+SdkProc sdk_resolve(SdkExport id)
+{
+    const size_t index = static_cast<size_t>(id);
+
+    const uint8_t state = g_states[index].load(std::memory_order_acquire);
+    if (state != SLOT_UNRESOLVED)
+        return g_procs[index].load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    // Another thread may have finished the lookup meanwhile
+    if (g_states[index].load(std::memory_order_relaxed) != SLOT_UNRESOLVED)
+        return g_procs[index].load(std::memory_order_relaxed);
+
+    SdkProc proc = nullptr;
+
+#ifdef _WIN32
+    const ExportEntry &entry = EXPORTS[index];
+    if (load_locked(entry.dll))
+    {
+        const int64_t start_ns = mono_now_ns();
+        proc = reinterpret_cast<SdkProc>(GetProcAddress(g_dlls[static_cast<size_t>(entry.dll)], entry.name));
+        g_stats.resolve_ns += mono_now_ns() - start_ns;
+
+        if (!proc)
+            std::cerr << "Missing function " << entry.name << " in " << sdk_dll_file(entry.dll)
+                      << " (GetLastError=" << GetLastError() << ")\n";
+    }
+#endif
+
+    if (proc)
+        ++g_stats.resolved;
+    else
+        ++g_stats.missing;
+
+    g_procs[index].store(proc, std::memory_order_relaxed);
+    g_states[index].store(proc ? SLOT_RESOLVED : SLOT_MISSING, std::memory_order_release);
+    return proc;
+}
+
+const SdkLoadStats &sdk_load_stats()
+{
+    return g_stats;
+}
@@ -0,0 +1,82 @@
+#ifndef SDK_LOADER_H
+#define SDK_LOADER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hantek_sdk.h"
+#include "sdk_exports.h"
+
+//------------------------------------------------------------------------------
+
+enum class SdkDll : uint8_t
+{
+    HTHardDll,
+    HTSoftDll,
+    MeasDll,
+};
+
+const size_t SDK_DLL_COUNT = 3;
+
+#define SDK_EXPORT_ID(dll, name) name,
+enum class SdkExport : uint16_t
+{
+    SDK_EXPORTS(SDK_EXPORT_ID)
+};
+#undef SDK_EXPORT_ID
+
+#define SDK_EXPORT_ONE(dll, name) +1
+const size_t SDK_EXPORT_COUNT = 0 SDK_EXPORTS(SDK_EXPORT_ONE);
+#undef SDK_EXPORT_ONE
+
+// Startup cost of the SDK, for the diagnostics
+struct SdkLoadStats
+{
+    int64_t  load_ns[SDK_DLL_COUNT] = {};  // LoadLibrary, 0 while not loaded
+    int64_t  resolve_ns = 0;                // all GetProcAddress calls
+    uint32_t resolved   = 0;
+    uint32_t missing    = 0;
+};
+
+typedef void (*SdkProc)();
+
+//------------------------------------------------------------------------------
+
+const char *sdk_dll_file(SdkDll dll);
+const char *sdk_export_name(SdkExport id);
+
+// Load a DLL up front, the others load on the first use of one of their exports
+bool sdk_load(SdkDll dll);
+void sdk_unload();
+
+// Address of an export, looked up once and cached. A missing export is
+// reported once and stays null. Always null outside Windows.
+SdkProc sdk_resolve(SdkExport id);
+
+inline bool sdk_available(SdkExport id)
+{
+    return sdk_resolve(id) != nullptr;
+}
+
+const SdkLoadStats &sdk_load_stats();
+
+//------------------------------------------------------------------------------
+
+// Bound to a PFN pointer in place of the export: resolves it on the first call
+// and forwards. A missing export returns 0, the SDK's failure value.
+template <SdkExport ID, typename Fn>
+struct SdkLazy;
+
+template <SdkExport ID, typename R, typename... Args>
+struct SdkLazy<ID, R (WINAPI *)(Args...)>
+{
+    static R WINAPI call(Args... args)
+    {
+        typedef R (WINAPI *Fn)(Args...);
+
+        const Fn fn = reinterpret_cast<Fn>(sdk_resolve(ID));
+        return fn ? fn(args...) : R();
+    }
+};
+
+#endif // SDK_LOADER_H
@@ -0,0 +1,253 @@
+#include "sdk_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "spsc_ring.h"
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+
+const size_t TRACE_THREAD_SLOTS   = 64;     // threads recording at the same time, the startup probe uses 33
+const size_t TRACE_RING_RECORDS   = 512;    // per thread, drained every 100 ms
+
+typedef SpscRing<SdkTraceRecord, TRACE_RING_RECORDS> TraceRing;
+
+enum SlotState : uint8_t
+{
+    SLOT_FREE,
+    SLOT_OWNED,
+    SLOT_RETIRED,       // owner exited, freed once the writer drained it
+};
+
+// One ring per recording thread, claimed on its first call and released when
+// it exits. Allocated on the first open and never freed, a caller still inside
+// sdk_trace_record() while the trace closes only writes into a ring.
+struct TraceSlot
+{
+    TraceRing ring;
+    std::atomic<uint8_t> state{SLOT_FREE};
+    std::atomic<uint64_t> dropped{0};
+};
+
+TraceSlot *g_slots = nullptr;
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint32_t> g_next_thread{0};
+std::atomic<uint64_t> g_unslotted{0};       // calls of threads that found no free slot
+
+std::mutex g_mutex;                         // open / close against the writer's wait only
+std::condition_variable g_wake;
+bool g_running = false;
+
+std::FILE *g_file = nullptr;
+int64_t g_start_ns = 0;
+uint64_t g_records = 0;                     // writer thread only
+std::thread g_thread;
+
+// The calling thread's slot, handed back when the thread exits
+struct ThreadSlot
+{
+    int      slot   = -1;
+    uint32_t thread = 0;
+
+    ~ThreadSlot()
+    {
+        if (slot >= 0)
+            g_slots[slot].state.store(SLOT_RETIRED, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+bool claim_slot(ThreadSlot &owner)
+{
+    for (size_t i = 0; i < TRACE_THREAD_SLOTS; ++i)
+    {
+        uint8_t expected = SLOT_FREE;
+        if (g_slots[i].state.compare_exchange_strong(expected, SLOT_OWNED, std::memory_order_acq_rel))
+        {
+            owner.slot   = static_cast<int>(i);
+            owner.thread = g_next_thread.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Everything the rings hold, each batch in the order the calls returned
+void collect(std::vector<SdkTraceRecord> &batch)
+{
+    for (size_t i = 0; i < TRACE_THREAD_SLOTS; ++i)
+    {
+        TraceSlot &slot = g_slots[i];
+
+        // Read the state first, a retired ring gets no more records
+        const uint8_t state = slot.state.load(std::memory_order_acquire);
+        if (state == SLOT_FREE)
+            continue;
+
+        SdkTraceRecord record;
+        while (slot.ring.try_pop(record))
+            batch.push_back(record);
+
+        if (state == SLOT_RETIRED)
+            slot.state.store(SLOT_FREE, std::memory_order_release);
+    }
+
+    std::sort(batch.begin(), batch.end(),
+              [](const SdkTraceRecord &a, const SdkTraceRecord &b) { return a.exit_ns < b.exit_ns; });
+}
+
+void run()
+{
+    std::vector<SdkTraceRecord> batch;
+    batch.reserve(TRACE_THREAD_SLOTS * TRACE_RING_RECORDS);
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+
+    for (;;)
+    {
+        g_wake.wait_for(lock, std::chrono::milliseconds(100), [] { return !g_running; });
+
+        const bool running = g_running;
+        lock.unlock();
+
+        collect(batch);
+        if (!batch.empty())
+        {
+            g_records += std::fwrite(batch.data(), sizeof(SdkTraceRecord), batch.size(), g_file);
+            batch.clear();
+        }
+
+        lock.lock();
+        if (!running)
+            break;
+    }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+
+bool sdk_trace_open(const char *path)
+{
+    g_file = std::fopen(path, "wb");
+    if (!g_file)
+    {
+        std::cerr << "Cannot create " << path << "\n";
+        return false;
+    }
+
+    if (!g_slots)
+        g_slots = new TraceSlot[TRACE_THREAD_SLOTS];
+
+    // Leftovers of a previous trace, written after it closed
+    std::vector<SdkTraceRecord> stale;
+    collect(stale);
+    for (size_t i = 0; i < TRACE_THREAD_SLOTS; ++i)
+        g_slots[i].dropped.store(0, std::memory_order_relaxed);
+    g_unslotted.store(0, std::memory_order_relaxed);
+
+    g_start_ns = mono_now_ns();
+
+    SdkTraceHeader header;
+    std::memcpy(header.magic, SDK_TRACE_MAGIC, sizeof(header.magic));
+    header.version     = SDK_TRACE_VERSION;
+    header.record_size = sizeof(SdkTraceRecord);
+    header.start_ns    = g_start_ns;
+    std::fwrite(&header, sizeof(header), 1, g_file);
+
+    g_records = 0;
+    g_running = true;
+
+    g_thread = std::thread(run);
+    g_enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+SdkTraceStats sdk_trace_close()
+{
+    if (!g_enabled.exchange(false))
+        return SdkTraceStats();
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_running = false;
+    }
+    g_wake.notify_one();
+    g_thread.join();
+
+    std::fclose(g_file);
+    g_file = nullptr;
+
+    uint64_t dropped = g_unslotted.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < TRACE_THREAD_SLOTS; ++i)
+        dropped += g_slots[i].dropped.load(std::memory_order_relaxed);
+
+    return {g_records, dropped};
+}
+
+bool sdk_trace_active()
+{
+    return g_enabled.load(std::memory_order_acquire);
+}
+
+// Lock-free and allocation-free, a full ring drops the record
+void sdk_trace_record(SdkTraceRecord &record)
+{
+    if (!g_enabled.load(std::memory_order_acquire))
+        return;
+
+    if (t_slot.slot < 0 && !claim_slot(t_slot))
+    {
+        g_unslotted.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceSlot &slot = g_slots[t_slot.slot];
+
+    record.thread    = t_slot.thread;
+    record.entry_ns -= g_start_ns;
+    record.exit_ns  -= g_start_ns;
+
+    if (!slot.ring.try_push(record))
+        slot.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool sdk_trace_read(const char *path, SdkTraceHeader &header, std::vector<SdkTraceRecord> &records)
+{
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, SDK_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SDK_TRACE_VERSION || header.record_size != sizeof(SdkTraceRecord))
+    {
+        std::cerr << path << " is not an SDK trace of this build\n";
+        std::fclose(file);
+        return false;
+    }
+
+    records.clear();
+
+    SdkTraceRecord record;
+    while (std::fread(&record, sizeof(record), 1, file) == 1)
+        records.push_back(record);
+
+    std::fclose(file);
+    return true;
+}
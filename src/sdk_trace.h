@@ -0,0 +1,109 @@
+#ifndef SDK_TRACE_H
+#define SDK_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "hantek_sdk.h"
+#include "mono_clock.h"
+#include "sdk_loader.h"
+
+//------------------------------------------------------------------------------
+
+// Binary SDK call trace: this header followed by one SdkTraceRecord per call.
+// Records are appended as the run goes in batches, each in the order its calls
+// returned; the count is whatever the file holds.
+const char     SDK_TRACE_MAGIC[8]   = {'S', 'D', 'K', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t SDK_TRACE_VERSION    = 2;
+const size_t   SDK_TRACE_MAX_ARGS   = 7;    // ddsSetFAOC
+
+struct SdkTraceHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    int64_t  start_ns;      // monotonic time the trace was opened
+};
+
+struct SdkTraceRecord
+{
+    uint16_t export_id;     // SdkExport, stable for one sdk_exports.h
+    uint8_t  arg_count;
+    uint8_t  reserved;
+    uint32_t thread;        // calling thread, numbered in order of its first call
+    double   rc;            // any return type by value, ddsSDKSetFre's is a float
+    int64_t  entry_ns;      // since SdkTraceHeader::start_ns
+    int64_t  exit_ns;
+    double   args[SDK_TRACE_MAX_ARGS];  // scalars by value, pointers as 0
+};
+
+struct SdkTraceStats
+{
+    uint64_t records;       // written to the file
+    uint64_t dropped;       // the writer fell behind
+};
+
+//------------------------------------------------------------------------------
+
+// Recording starts once the file is created. Every calling thread appends to a
+// ring of its own, lock-free, a background thread drains the rings to the file.
+bool sdk_trace_open(const char *path);
+SdkTraceStats sdk_trace_close();
+bool sdk_trace_active();
+
+void sdk_trace_record(SdkTraceRecord &record);
+
+// Whole trace into memory, false with a message if the file is not one
+bool sdk_trace_read(const char *path, SdkTraceHeader &header, std::vector<SdkTraceRecord> &records);
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+double sdk_trace_arg(T value)
+{
+    if constexpr (std::is_pointer<T>::value)
+        return 0.0;
+    else
+        return static_cast<double>(value);
+}
+
+// Bound to a PFN pointer in front of the real entry point (next): records the
+// call's arguments, rc and the timestamps around it, then returns the rc.
+template <SdkExport ID, typename Fn>
+struct SdkTraced;
+
+template <SdkExport ID, typename R, typename... Args>
+struct SdkTraced<ID, R (WINAPI *)(Args...)>
+{
+    typedef R (WINAPI *Fn)(Args...);
+
+    static Fn next;
+
+    static R WINAPI call(Args... args)
+    {
+        static_assert(sizeof...(Args) <= SDK_TRACE_MAX_ARGS, "SDK_TRACE_MAX_ARGS");
+
+        SdkTraceRecord record = {};
+        record.export_id = static_cast<uint16_t>(ID);
+        record.arg_count = static_cast<uint8_t>(sizeof...(Args));
+
+        const double values[] = {sdk_trace_arg(args)...};
+        for (size_t i = 0; i < sizeof...(Args); ++i)
+            record.args[i] = values[i];
+
+        record.entry_ns = mono_now_ns();
+        const R rc = next(args...);
+        record.exit_ns = mono_now_ns();
+
+        record.rc = sdk_trace_arg(rc);
+        sdk_trace_record(record);
+        return rc;
+    }
+};
+
+template <SdkExport ID, typename R, typename... Args>
+typename SdkTraced<ID, R (WINAPI *)(Args...)>::Fn SdkTraced<ID, R (WINAPI *)(Args...)>::next = nullptr;
+
+#endif // SDK_TRACE_H
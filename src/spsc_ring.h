@@ -0,0 +1,62 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+// Fixed capacity single producer / single consumer ring buffer. Both sides are
+// wait-free: try_push() fails instead of blocking when the ring is full and
+// try_pop() fails when it is empty. T must be trivially copyable.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool try_push(const T &item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail_cache == Capacity)
+        {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tail_cache == Capacity)
+                return false;
+        }
+
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head_cache)
+        {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail == m_head_cache)
+                return false;
+        }
+
+        item = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_tail_cache = 0;
+
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_head_cache = 0;
+
+    alignas(64) T m_items[Capacity];
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,56 @@
+#include "stop_signal.h"
+
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <csignal>
+#endif
+
+//------------------------------------------------------------------------------
+
+static std::atomic<bool> g_stop_requested{false};
+
+#ifdef _WIN32
+
+static BOOL WINAPI console_ctrl_handler(DWORD ctrl_type)
+{
+    if (ctrl_type == CTRL_C_EVENT || ctrl_type == CTRL_BREAK_EVENT || ctrl_type == CTRL_CLOSE_EVENT)
+    {
+        request_stop();
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+void install_stop_handler()
+{
+    SetConsoleCtrlHandler(console_ctrl_handler, TRUE);
+}
+
+#else
+
+static void signal_handler(int)
+{
+    request_stop();
+}
+
+void install_stop_handler()
+{
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+}
+
+#endif
+
+bool stop_requested()
+{
+    return g_stop_requested.load(std::memory_order_relaxed);
+}
+
+void request_stop()
+{
+    g_stop_requested.store(true, std::memory_order_relaxed);
+}
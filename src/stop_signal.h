@@ -0,0 +1,13 @@
+#ifndef STOP_SIGNAL_H
+#define STOP_SIGNAL_H
+
+//------------------------------------------------------------------------------
+
+// Route Ctrl-C / console close (Windows) or SIGINT / SIGTERM (POSIX) to a stop
+// flag, so the transmit loops can finish the current second and report.
+void install_stop_handler();
+
+bool stop_requested();
+void request_stop();
+
+#endif // STOP_SIGNAL_H
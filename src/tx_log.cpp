@@ -0,0 +1,357 @@
+#include "tx_log.h"
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+#include "dcf77_frame.h"
+#include "mono_clock.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+const int TX_LOG_POLL_MS = 20;
+
+static double ns_to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / NS_PER_MS;
+}
+
+//------------------------------------------------------------------------------
+
+TxLogger::TxLogger()
+{
+}
+
+TxLogger::~TxLogger()
+{
+    stop();
+}
+
+void TxLogger::start(int64_t epoch_ns, const EdgeTimingHistograms *histograms, TxTraceWriter *trace)
+{
+    m_epoch_ns   = epoch_ns;
+    m_histograms = histograms;
+    m_trace      = trace;
+
+    // Tells tx_analyze where the minute the previous run of the day stopped in ends
+    if (m_trace)
+    {
+        m_utc_minus_mono_ns = sample_utc_mono_offset().utc_minus_mono_ns;
+        m_trace->append({TX_TRACE_RUN_START, 0, 0, 0, 0, 0, mono_now_ns() + m_utc_minus_mono_ns, 0});
+    }
+
+    // The histograms start empty, like the zeroed first previous copy
+    if (m_histograms)
+    {
+        for (auto &snapshot : m_snapshots)
+        {
+            snapshot.reset(new EdgeTimingSnapshot());
+            if (!m_previous_snapshot)
+                m_previous_snapshot = snapshot.get();
+            else
+                m_free_snapshots.try_push(snapshot.get());
+        }
+    }
+
+    m_running.store(true, std::memory_order_relaxed);
+    m_thread = std::thread(&TxLogger::run, this);
+}
+
+void TxLogger::stop()
+{
+    m_running.store(false, std::memory_order_relaxed);
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    // Nothing was logged after the last loss, report it from here
+    if (m_unreported_dropped)
+    {
+        TxLogRecord record;
+        record.kind    = TxLogKind::Dropped;
+        record.dropped = {m_unreported_dropped, utc_now_ns()};
+        m_unreported_dropped = 0;
+
+        format(record);
+        std::cout.flush();
+    }
+}
+
+void TxLogger::print_totals()
+{
+    if (!m_histograms)
+        return;
+
+    std::unique_ptr<EdgeTimingSnapshot> totals(new EdgeTimingSnapshot());
+    take_snapshot(*totals);
+
+    std::cout << "Edge timing over the whole run:\n";
+    print_histograms(*totals, nullptr);
+    std::cout.flush();
+}
+
+// False if the record was dropped
+bool TxLogger::push(const TxLogRecord &record)
+{
+    // The loss is logged in front of the next record that fits
+    if (m_unreported_dropped)
+    {
+        TxLogRecord dropped;
+        dropped.kind    = TxLogKind::Dropped;
+        dropped.dropped = {m_unreported_dropped, utc_now_ns()};
+
+        if (m_ring.try_push(dropped))
+            m_unreported_dropped = 0;
+    }
+
+    if (m_unreported_dropped || !m_ring.try_push(record))
+    {
+        ++m_unreported_dropped;
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void TxLogger::log_edge(uint8_t bit_index, uint8_t bit_value, uint8_t edge, int64_t planned_ns, int64_t actual_ns, uint32_t rc)
+{
+    TxLogRecord record;
+    record.kind = TxLogKind::Edge;
+    record.edge = {bit_index, bit_value, edge, rc, planned_ns, actual_ns};
+    push(record);
+}
+
+void TxLogger::log_frame(int64_t utc_minute_ns, uint64_t bits, int64_t taken_utc_ns)
+{
+    TxLogRecord record;
+    record.kind  = TxLogKind::Frame;
+    record.frame = {utc_minute_ns, bits, taken_utc_ns};
+    push(record);
+}
+
+void TxLogger::log_minute(const TxMinuteRecord &minute)
+{
+    TxLogRecord record;
+    record.kind       = TxLogKind::MinuteStats;
+    record.minute     = minute;
+    record.histograms = nullptr;
+
+    // Frozen here at the rollover, before the next minute's edges come in
+    if (m_histograms)
+    {
+        if (m_spare_snapshot)
+            std::swap(record.histograms, m_spare_snapshot);
+        else
+            m_free_snapshots.try_pop(record.histograms);
+
+        if (record.histograms)
+            take_snapshot(*record.histograms);
+    }
+
+    if (!push(record))
+        m_spare_snapshot = record.histograms;
+}
+
+void TxLogger::log_skew(const TxSkewRecord &skew)
+{
+    TxLogRecord record;
+    record.kind = TxLogKind::Skew;
+    record.skew = skew;
+    push(record);
+}
+
+void TxLogger::log_outage(const TxOutageRecord &outage)
+{
+    TxLogRecord record;
+    record.kind = TxLogKind::Outage;
+    record.outage = outage;
+    push(record);
+}
+
+void TxLogger::log_notice(const char *text)
+{
+    TxLogRecord record;
+    record.kind   = TxLogKind::Notice;
+    record.notice = text;
+    push(record);
+}
+
+//------------------------------------------------------------------------------
+
+void TxLogger::run()
+{
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(TX_LOG_POLL_MS));
+    }
+
+    drain();
+}
+
+void TxLogger::drain()
+{
+    TxLogRecord record;
+    bool wrote = false;
+
+    while (m_ring.try_pop(record))
+    {
+        format(record);
+        wrote = true;
+    }
+
+    if (wrote)
+        std::cout.flush();
+}
+
+void TxLogger::format(const TxLogRecord &record)
+{
+    switch (record.kind)
+    {
+    case TxLogKind::Edge:
+    {
+        const TxEdgeRecord &edge = record.edge;
+
+        if (m_trace)
+        {
+            m_trace->append({TX_TRACE_EDGE, edge.bit_index, edge.bit_value, edge.edge, edge.rc,
+                             edge.planned_ns + m_utc_minus_mono_ns, edge.actual_ns + m_utc_minus_mono_ns, 0});
+            break;
+        }
+
+        if (edge.edge == PULSE_EDGE_START)
+        {
+            std::cout << "Transmitting bit " << static_cast<int>(edge.bit_value)
+                      << " bit idx : " << static_cast<int>(edge.bit_index);
+        }
+        else
+        {
+            std::cout << "  end of pulse bit idx : " << static_cast<int>(edge.bit_index);
+        }
+
+        std::cout << " planned " << ns_to_ms(edge.planned_ns - m_epoch_ns) << " ms"
+                  << " late " << ns_to_ms(edge.actual_ns - edge.planned_ns) << " ms"
+                  << " rc = " << edge.rc << "\n";
+        break;
+    }
+
+    case TxLogKind::Frame:
+    {
+        if (m_trace)
+        {
+            // Follows UTC steps and slews at minute granularity
+            m_utc_minus_mono_ns = sample_utc_mono_offset().utc_minus_mono_ns;
+            m_trace->append({TX_TRACE_FRAME, 0, 0, 0, 0, record.frame.utc_minute_ns, record.frame.taken_utc_ns,
+                             record.frame.bits});
+        }
+
+        char text[DCF77_FRAME_TEXT_MAX];
+        std::cout << "Transmitting frame: ";
+        std::cout.write(text, static_cast<std::streamsize>(dcf77_format_frame(record.frame.bits, text))) << "\n";
+        break;
+    }
+
+    case TxLogKind::MinuteStats:
+    {
+        const TxMinuteRecord &minute = record.minute;
+
+        std::cout << "Transmitting sync bit, edge lateness min/avg/max "
+                  << ns_to_ms(minute.lateness_min_ns) << "/" << ns_to_ms(minute.lateness_mean_ns) << "/"
+                  << ns_to_ms(minute.lateness_max_ns) << " ms\n";
+
+        std::cout << "SDK latency estimate " << ns_to_ms(minute.sdk_latency_ns)
+                  << " ms (deviation " << ns_to_ms(minute.sdk_deviation_ns) << " ms), issuing "
+                  << ns_to_ms(minute.lead_ns) << " ms early, amplitude change error min/avg/max "
+                  << ns_to_ms(minute.edge_error_min_ns) << "/" << ns_to_ms(minute.edge_error_mean_ns) << "/"
+                  << ns_to_ms(minute.edge_error_max_ns) << " ms\n";
+
+        std::cout << "Second period error " << minute.period_ppm << " ppm (run " << minute.total_period_ppm
+                  << " ppm), servo trim " << ns_to_ms(minute.servo_trim_ns) << " ms\n";
+
+        if (minute.burst_pulses)
+        {
+            std::cout << "Burst pulse width error min/avg/max "
+                      << ns_to_ms(minute.pulse_width_error_min_ns) << "/" << ns_to_ms(minute.pulse_width_error_mean_ns) << "/"
+                      << ns_to_ms(minute.pulse_width_error_max_ns) << " ms (" << minute.burst_pulses << " bursts)\n";
+        }
+
+        if (minute.utc_locked)
+        {
+            std::cout << "UTC phase error min/avg/max "
+                      << ns_to_ms(minute.phase_min_ns) << "/" << ns_to_ms(minute.phase_mean_ns) << "/"
+                      << ns_to_ms(minute.phase_max_ns) << " ms\n";
+        }
+
+        // Percentiles of this minute's edges only
+        if (record.histograms)
+        {
+            print_histograms(*record.histograms, m_previous_snapshot);
+            m_free_snapshots.try_push(m_previous_snapshot);
+            m_previous_snapshot = record.histograms;
+        }
+        else if (m_histograms)
+        {
+            std::cout << "  edge timing histograms skipped, no free copy\n";
+        }
+        break;
+    }
+
+    case TxLogKind::Skew:
+    {
+        const TxSkewRecord &skew = record.skew;
+
+        if (skew.device == TX_SKEW_SPREAD)
+            std::cout << "Fan-out edge spread min/avg/max ";
+        else
+            std::cout << "  device [" << static_cast<int>(skew.device) << "] skew min/avg/max ";
+
+        std::cout << ns_to_ms(skew.min_ns) << "/" << ns_to_ms(skew.mean_ns) << "/" << ns_to_ms(skew.max_ns)
+                  << " ms (" << skew.edges << " edges)\n";
+        break;
+    }
+
+    case TxLogKind::Outage:
+    {
+        const TxOutageRecord &outage = record.outage;
+
+        std::cout << "Device back after " << ns_to_ms(outage.outage_ns) << " ms outage, reconnected in "
+                  << ns_to_ms(outage.recovery_ns) << " ms (" << outage.attempts << " attempts), "
+                  << outage.missed_edges << " edges missed, resuming at bit " << static_cast<int>(outage.bit_index)
+                  << "\n";
+        break;
+    }
+
+    case TxLogKind::Notice:
+        std::cout << record.notice << "\n";
+        break;
+
+    case TxLogKind::Dropped:
+        if (m_trace)
+            m_trace->append({TX_TRACE_DROPPED, 0, 0, 0, 0, 0, record.dropped.utc_ns, record.dropped.count});
+
+        std::cout << "Log ring full, dropped " << record.dropped.count << " records\n";
+        break;
+    }
+}
+
+void TxLogger::take_snapshot(EdgeTimingSnapshot &snapshot) const
+{
+    m_histograms->lateness.snapshot(snapshot.metrics[0]);
+    m_histograms->sdk_call.snapshot(snapshot.metrics[1]);
+    m_histograms->change_error.snapshot(snapshot.metrics[2]);
+}
+
+void TxLogger::print_histograms(const EdgeTimingSnapshot &now, const EdgeTimingSnapshot *since)
+{
+    const char *names[3] = {"edge lateness", "SDK call", "change error"};
+
+    for (int metric = 0; metric < 3; ++metric)
+    {
+        const LatencyPercentiles p = latency_percentiles(now.metrics[metric], since ? &since->metrics[metric] : nullptr);
+
+        std::cout << "  " << names[metric] << " p50/p99/p99.9/max "
+                  << ns_to_ms(p.p50_ns) << "/" << ns_to_ms(p.p99_ns) << "/" << ns_to_ms(p.p999_ns) << "/"
+                  << ns_to_ms(p.max_ns) << " ms (" << p.count << " edges)\n";
+    }
+}
@@ -0,0 +1,183 @@
+#ifndef TX_LOG_H
+#define TX_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "latency_histogram.h"
+#include "pulse_program.h"
+#include "spsc_ring.h"
+#include "tx_trace.h"
+
+//------------------------------------------------------------------------------
+
+const size_t TX_LOG_CAPACITY  = 1024;   // > 4 minutes of edges
+const size_t TX_LOG_SNAPSHOTS = 4;      // histogram copies: the logger's previous one and three in flight
+
+enum class TxLogKind : uint8_t
+{
+    Edge,
+    Frame,
+    MinuteStats,
+    Skew,
+    Outage,
+    Notice,
+    Dropped,
+};
+
+struct TxEdgeRecord
+{
+    uint8_t  bit_index;
+    uint8_t  bit_value;
+    uint8_t  edge;          // PulseEdge
+    uint32_t rc;
+    int64_t  planned_ns;    // monotonic deadline
+    int64_t  actual_ns;     // predicted monotonic time the amplitude changed
+};
+
+struct TxFrameRecord
+{
+    int64_t  utc_minute_ns;
+    uint64_t bits;
+    int64_t  taken_utc_ns;  // when the timing thread took the frame up
+};
+
+// Records the ring had no room for, logged in their place once it has
+struct TxDroppedRecord
+{
+    uint64_t count;
+    int64_t  utc_ns;
+};
+
+struct TxMinuteRecord
+{
+    bool    utc_locked;
+    int64_t lateness_min_ns;
+    int64_t lateness_mean_ns;
+    int64_t lateness_max_ns;
+    int64_t phase_min_ns;
+    int64_t phase_mean_ns;
+    int64_t phase_max_ns;
+    int64_t edge_error_min_ns;      // predicted amplitude change - deadline
+    int64_t edge_error_mean_ns;
+    int64_t edge_error_max_ns;
+    int64_t sdk_latency_ns;         // current SDK call estimate
+    int64_t sdk_deviation_ns;
+    int64_t lead_ns;                // how early calls are issued
+    double  period_ppm;             // mean start-to-start period error, this minute
+    double  total_period_ppm;       // ... and since the first second
+    int64_t servo_trim_ns;
+    uint64_t burst_pulses;          // burst mode only: reductions counted by the DDS
+    int64_t pulse_width_error_min_ns;   // predicted width - nominal
+    int64_t pulse_width_error_mean_ns;
+    int64_t pulse_width_error_max_ns;
+};
+
+const uint8_t TX_SKEW_SPREAD = 0xff;    // TxSkewRecord of the whole fan-out group
+
+// Fan-out only: one device's edges against the group this minute
+struct TxSkewRecord
+{
+    uint8_t  device;        // slot, or TX_SKEW_SPREAD for the latest - earliest spread
+    uint64_t edges;
+    int64_t  min_ns;        // lateness - mean lateness of the group
+    int64_t  mean_ns;
+    int64_t  max_ns;
+};
+
+// A device that dropped off USB and was reconnected
+struct TxOutageRecord
+{
+    uint8_t  bit_index;     // first bit played again
+    uint32_t attempts;      // reconnect attempts
+    uint32_t missed_edges;
+    int64_t  recovery_ns;   // failed call -> device set up again
+    int64_t  outage_ns;     // failed call -> first edge played again
+};
+
+// The edge timing histograms frozen at a minute rollover
+struct EdgeTimingSnapshot
+{
+    LatencyHistogram::Snapshot metrics[3];  // lateness / sdk_call / change_error
+};
+
+// Binary log record, formatting happens on the logger thread only
+struct TxLogRecord
+{
+    TxLogKind kind;
+    EdgeTimingSnapshot *histograms;     // MinuteStats: taken by log_minute, null if no copy was free
+    union
+    {
+        TxEdgeRecord   edge;
+        TxFrameRecord  frame;
+        TxMinuteRecord minute;
+        TxSkewRecord   skew;
+        TxOutageRecord outage;
+        TxDroppedRecord dropped;
+        const char    *notice;  // string literal
+    };
+};
+
+//------------------------------------------------------------------------------
+
+// Asynchronous transmit log. The timing thread only copies fixed-size records
+// into an SPSC ring, a background thread formats them to std::cout. When the
+// ring is full records are dropped and counted instead of blocking, the count
+// goes into the log (and trace) as a record of its own where the loss was.
+//
+// With histograms attached every minute record also prints the percentiles of
+// the edges recorded since the previous minute record. log_minute() copies
+// the histograms on the timing thread, so the minute's figures are exactly the
+// minute's edges; the copies cycle between the two threads through a ring. With a transmit trace
+// attached edges and frames are also appended to it, and edges are no longer
+// printed one per line.
+class TxLogger
+{
+public:
+    TxLogger();
+    ~TxLogger();
+
+    // Planned edge times are printed relative to epoch_ns
+    void start(int64_t epoch_ns, const EdgeTimingHistograms *histograms = nullptr, TxTraceWriter *trace = nullptr);
+    void stop();
+
+    // Percentiles over the whole run, call after stop()
+    void print_totals();
+
+    void log_edge(uint8_t bit_index, uint8_t bit_value, uint8_t edge, int64_t planned_ns, int64_t actual_ns, uint32_t rc);
+    void log_frame(int64_t utc_minute_ns, uint64_t bits, int64_t taken_utc_ns);
+    void log_minute(const TxMinuteRecord &minute);
+    void log_skew(const TxSkewRecord &skew);
+    void log_outage(const TxOutageRecord &outage);
+    void log_notice(const char *text);
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    bool push(const TxLogRecord &record);
+    void run();
+    void drain();
+    void format(const TxLogRecord &record);
+    void take_snapshot(EdgeTimingSnapshot &snapshot) const;
+    void print_histograms(const EdgeTimingSnapshot &now, const EdgeTimingSnapshot *since);
+
+    SpscRing<TxLogRecord, TX_LOG_CAPACITY> m_ring;
+
+    int64_t m_epoch_ns = 0;
+
+    const EdgeTimingHistograms *m_histograms = nullptr;
+    TxTraceWriter *m_trace = nullptr;
+    int64_t m_utc_minus_mono_ns = 0;    // trace times, re-sampled every frame
+    std::unique_ptr<EdgeTimingSnapshot> m_snapshots[TX_LOG_SNAPSHOTS];
+    SpscRing<EdgeTimingSnapshot *, TX_LOG_SNAPSHOTS> m_free_snapshots;  // logger thread -> timing thread
+    EdgeTimingSnapshot *m_spare_snapshot    = nullptr;  // timing thread, its minute record was dropped
+    EdgeTimingSnapshot *m_previous_snapshot = nullptr;  // logger thread, the last minute printed
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_unreported_dropped = 0;     // timing thread, not yet in the ring
+    std::thread m_thread;
+};
+
+#endif // TX_LOG_H
@@ -0,0 +1,242 @@
+#include "tx_trace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "dcf77_encoder.h"
+#include "mono_clock.h"
+
+//------------------------------------------------------------------------------
+
+const int64_t NS_PER_DAY = 86400 * NS_PER_S;
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+//------------------------------------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char *path, bool writable, uint64_t size)
+{
+    close();
+
+    m_file = CreateFileA(path, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(m_file, &file_size))
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(file_size.QuadPart);
+    if (writable && m_size < size)
+        m_size = size;
+
+    // Mapping a larger size than the file grows it
+    m_mapping = m_size ? CreateFileMappingA(m_file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                            static_cast<DWORD>(m_size >> 32), static_cast<DWORD>(m_size), nullptr)
+                       : nullptr;
+    if (!m_mapping)
+    {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<uint8_t *>(MapViewOfFile(m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_file    = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+    m_data    = nullptr;
+    m_size    = 0;
+}
+#else
+bool MappedFile::open(const char *path, bool writable, uint64_t size)
+{
+    close();
+
+    m_fd = ::open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (m_fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+    {
+        close();
+        return false;
+    }
+
+    m_size = static_cast<uint64_t>(st.st_size);
+
+    // Sparse, only the pages written take disk space
+    if (writable && m_size < size)
+    {
+        if (ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+        {
+            close();
+            return false;
+        }
+        m_size = size;
+    }
+
+    void *data = m_size ? mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0)
+                        : MAP_FAILED;
+    if (data == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<uint8_t *>(data);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+
+    m_fd   = -1;
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
+
+//------------------------------------------------------------------------------
+
+std::string tx_trace_file_name(int64_t day_utc_ns)
+{
+    const CivilDate date = civil_from_days(floor_div(day_utc_ns, NS_PER_DAY));
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "dcf77-tx-%04d-%02u-%02u.bin", date.year, date.month, date.day);
+    return name;
+}
+
+const TxTraceHeader *tx_trace_header(const MappedFile &file)
+{
+    if (file.size() < sizeof(TxTraceHeader))
+        return nullptr;
+
+    const TxTraceHeader *header = reinterpret_cast<const TxTraceHeader *>(file.data());
+
+    if (std::memcmp(header->magic, TX_TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != TX_TRACE_VERSION || header->record_size != sizeof(TxTraceRecord) ||
+        header->count > header->capacity ||
+        file.size() < sizeof(TxTraceHeader) + header->capacity * sizeof(TxTraceRecord))
+        return nullptr;
+
+    return header;
+}
+
+//------------------------------------------------------------------------------
+
+TxTraceWriter::TxTraceWriter(const char *dir)
+    : m_dir(dir)
+{
+}
+
+bool TxTraceWriter::open_day(int64_t day_utc_ns)
+{
+    close();
+    m_day_utc_ns = day_utc_ns;
+
+    m_path = m_dir + "/" + tx_trace_file_name(day_utc_ns);
+
+    const uint64_t size = sizeof(TxTraceHeader) + TX_TRACE_DAY_RECORDS * sizeof(TxTraceRecord);
+    if (!m_file.open(m_path.c_str(), true, size))
+    {
+        std::cerr << "Cannot map " << m_path << ", transmit trace disabled for that day\n";
+        return false;
+    }
+
+    TxTraceHeader *header = reinterpret_cast<TxTraceHeader *>(m_file.data());
+
+    // A new file reads as zeros, an existing one must be a trace of the same day
+    if (header->version == 0)
+    {
+        std::memcpy(header->magic, TX_TRACE_MAGIC, sizeof(header->magic));
+        header->version     = TX_TRACE_VERSION;
+        header->record_size = sizeof(TxTraceRecord);
+        header->day_utc_ns  = day_utc_ns;
+        header->capacity    = TX_TRACE_DAY_RECORDS;
+        header->count       = 0;
+    }
+    else if (tx_trace_header(m_file) != header || header->day_utc_ns != day_utc_ns)
+    {
+        std::cerr << m_path << " is not a transmit trace of this version, not appending to it\n";
+        m_file.close();
+        return false;
+    }
+
+    m_header  = header;
+    m_records = reinterpret_cast<TxTraceRecord *>(header + 1);
+    ++m_stats.files;
+    return true;
+}
+
+void TxTraceWriter::append(const TxTraceRecord &record)
+{
+    const int64_t day_utc_ns = floor_div(record.actual_utc_ns, NS_PER_DAY) * NS_PER_DAY;
+
+    // Retried only on the next day, not on every record
+    if (day_utc_ns != m_day_utc_ns)
+        open_day(day_utc_ns);
+
+    if (!m_header || m_header->count >= m_header->capacity)
+    {
+        ++m_stats.dropped;
+        return;
+    }
+
+    m_records[m_header->count] = record;
+
+    // The record is complete in the page cache before it is counted
+    std::atomic_thread_fence(std::memory_order_release);
+    ++m_header->count;
+    ++m_stats.records;
+}
+
+void TxTraceWriter::close()
+{
+    m_file.close();
+    m_header  = nullptr;
+    m_records = nullptr;
+}
@@ -0,0 +1,131 @@
+#ifndef TX_TRACE_H
+#define TX_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+// Daily transmit trace <dir>/dcf77-tx-YYYY-MM-DD.bin, named after the UTC day
+// of its records: this header followed by capacity fixed-size records of which
+// the first count are valid. The file is sized for a whole day when created
+// and stays mapped, appending is a record copy and a store of count, so a
+// crash loses at most the record being written. Later runs of the same day
+// append to the same file.
+const char     TX_TRACE_MAGIC[8]     = {'D', 'C', 'F', '7', '7', 'T', 'X', 'T'};
+const uint32_t TX_TRACE_VERSION      = 1;
+const uint64_t TX_TRACE_DAY_RECORDS  = 1 << 18;    // 172800 edges and 1440 frames a day, room for restarts
+
+enum TxTraceKind : uint8_t
+{
+    TX_TRACE_EDGE  = 1,
+    TX_TRACE_FRAME = 2,     // precedes the edges of its minute
+    TX_TRACE_DROPPED = 3,   // follows records the transmitter's log ring dropped
+    TX_TRACE_RUN_START = 4, // first record of every transmitter run
+};
+
+struct TxTraceHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    int64_t  day_utc_ns;    // 00:00 UTC of the file's day
+    uint64_t capacity;
+    uint64_t count;         // written after each record
+    uint64_t reserved[3];
+};
+
+struct TxTraceRecord
+{
+    uint8_t  kind;          // TxTraceKind
+    uint8_t  bit_index;     // edge: second of the minute
+    uint8_t  bit_value;
+    uint8_t  edge;          // PulseEdge
+    uint32_t rc;
+    int64_t  planned_utc_ns;    // edge: deadline; frame: UTC minute it announces, 0 for a fixed test frame
+    int64_t  actual_utc_ns;     // edge: predicted amplitude change; frame: when the transmitter took it up;
+                                // dropped: when the first record after the loss was logged; run start: when
+                                // the logger started
+    uint64_t frame_bits;        // frame only; dropped: number of records lost
+};
+
+struct TxTraceStats
+{
+    uint64_t records;       // appended by this writer
+    uint64_t dropped;       // file full or not writable
+    uint32_t files;         // opened, one per day
+};
+
+//------------------------------------------------------------------------------
+
+// Whole file mapped into memory, read only or read / write
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Read only: the file as it is. Writable: created if missing and grown to
+    // at least size bytes.
+    bool open(const char *path, bool writable, uint64_t size = 0);
+    void close();
+
+    uint8_t *data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file    = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    uint8_t *m_data = nullptr;
+    uint64_t m_size = 0;
+};
+
+// Appends to the trace of the record's UTC day, switching files at midnight.
+// Single thread.
+class TxTraceWriter
+{
+public:
+    explicit TxTraceWriter(const char *dir);
+
+    void append(const TxTraceRecord &record);
+    void close();
+
+    const TxTraceStats &stats() const { return m_stats; }
+    const std::string &path() const { return m_path; }
+
+private:
+    bool open_day(int64_t day_utc_ns);
+
+    std::string m_dir;
+    std::string m_path;
+    MappedFile m_file;
+    TxTraceHeader *m_header = nullptr;
+    TxTraceRecord *m_records = nullptr;
+    int64_t m_day_utc_ns = INT64_MIN;
+    TxTraceStats m_stats = {};
+};
+
+// File name of a day's trace, without the directory
+std::string tx_trace_file_name(int64_t day_utc_ns);
+
+// Header and records of a mapped trace, null if the file is not one
+const TxTraceHeader *tx_trace_header(const MappedFile &file);
+
+inline const TxTraceRecord *tx_trace_records(const TxTraceHeader *header)
+{
+    return reinterpret_cast<const TxTraceRecord *>(header + 1);
+}
+
+#endif // TX_TRACE_H
@@ -0,0 +1,65 @@
+#include "utc_clock.h"
+
+#include "mono_clock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//------------------------------------------------------------------------------
+
+const int UTC_MONO_SAMPLE_ATTEMPTS = 3;
+
+#ifdef _WIN32
+
+// 100 ns intervals between 1601-01-01 (FILETIME origin) and 1970-01-01
+const int64_t FILETIME_UNIX_EPOCH = 116444736000000000LL;
+
+int64_t utc_now_ns()
+{
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft);
+
+    int64_t ticks = (static_cast<int64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    return (ticks - FILETIME_UNIX_EPOCH) * 100;
+}
+
+#else
+
+int64_t utc_now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * NS_PER_S + ts.tv_nsec;
+}
+
+#endif
+
+UtcMonoOffset sample_utc_mono_offset()
+{
+    UtcMonoOffset best = {0, INT64_MAX};
+
+    for (int i = 0; i < UTC_MONO_SAMPLE_ATTEMPTS; ++i)
+    {
+        int64_t mono_before = mono_now_ns();
+        int64_t utc         = utc_now_ns();
+        int64_t mono_after  = mono_now_ns();
+
+        int64_t width = mono_after - mono_before;
+        if (width < best.uncertainty_ns)
+        {
+            best.utc_minus_mono_ns = utc - (mono_before + width / 2);
+            best.uncertainty_ns    = width;
+        }
+    }
+
+    return best;
+}
+
+int64_t next_utc_minute_ns(int64_t utc_ns)
+{
+    int64_t rem = utc_ns % NS_PER_MINUTE;
+    return rem == 0 ? utc_ns : utc_ns + (NS_PER_MINUTE - rem);
+}
@@ -0,0 +1,29 @@
+#ifndef UTC_CLOCK_H
+#define UTC_CLOCK_H
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+
+const int64_t NS_PER_MINUTE = 60LL * 1000000000LL;
+
+// Offset between the system (UTC) clock and the monotonic clock
+struct UtcMonoOffset
+{
+    int64_t utc_minus_mono_ns;
+    int64_t uncertainty_ns;     // width of the tightest monotonic bracket
+};
+
+//------------------------------------------------------------------------------
+
+// System wall-clock time in nanoseconds since 1970-01-01 00:00:00 UTC
+int64_t utc_now_ns();
+
+// Sample the UTC - monotonic offset, bracketing the UTC read between two
+// monotonic reads and keeping the tightest of a few attempts
+UtcMonoOffset sample_utc_mono_offset();
+
+// First UTC minute boundary at or after utc_ns
+int64_t next_utc_minute_ns(int64_t utc_ns);
+
+#endif // UTC_CLOCK_H
@@ -0,0 +1,273 @@
+// Bulk DCF77 test vector generator / validator
+//
+//   dcf77_frames generate <first_year> <years> <file> [--threads N]
+//   dcf77_frames validate <file> [--threads N]
+//   dcf77_frames bench <first_year> <years> [--threads N]
+//   dcf77_frames dump <file> [<text_file>]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "dcf77_batch.h"
+#include "dcf77_encoder.h"
+#include "dcf77_frame.h"
+#include "mono_clock.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+const uint64_t BLOCK_FRAMES = 1u << 24;     // 128 MB per block
+
+struct ToolOptions
+{
+    unsigned threads = 0;
+};
+
+static void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " generate <first_year> <years> <file> [--threads N]\n"
+              << "       " << argv0 << " validate <file> [--threads N]\n"
+              << "       " << argv0 << " bench <first_year> <years> [--threads N]\n"
+              << "       " << argv0 << " dump <file> [<text_file>]\n";
+}
+
+static int64_t year_start_ns(int year)
+{
+    return days_from_civil(year, 1, 1) * 86400 * NS_PER_S;
+}
+
+static uint64_t minutes_in_years(int first_year, int years)
+{
+    return static_cast<uint64_t>((year_start_ns(first_year + years) - year_start_ns(first_year)) / NS_PER_MINUTE);
+}
+
+static void print_rate(const char *what, uint64_t frames, int64_t elapsed_ns, unsigned threads)
+{
+    const double seconds = static_cast<double>(elapsed_ns) / NS_PER_S;
+
+    std::cout << what << " " << frames << " frames in " << seconds << " s, "
+              << (seconds > 0 ? static_cast<double>(frames) / seconds / 1e6 : 0.0) << " M frames/s ("
+              << threads << " threads)\n";
+}
+
+//------------------------------------------------------------------------------
+
+static int generate(int first_year, int years, const char *path, unsigned threads)
+{
+    Dcf77BatchHeader header;
+    std::memcpy(header.magic, DCF77_BATCH_MAGIC, sizeof(header.magic));
+    header.version             = DCF77_BATCH_VERSION;
+    header.reserved            = 0;
+    header.first_utc_minute_ns = year_start_ns(first_year);
+    header.count               = minutes_in_years(first_year, years);
+
+    std::FILE *file = std::fopen(path, "wb");
+    if (!file)
+    {
+        std::cerr << "Cannot create " << path << "\n";
+        return 1;
+    }
+
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    std::vector<uint64_t> block(BLOCK_FRAMES);
+    int64_t encode_ns = 0;
+
+    for (uint64_t done = 0; done < header.count; )
+    {
+        const uint64_t count = header.count - done < BLOCK_FRAMES ? header.count - done : BLOCK_FRAMES;
+
+        const int64_t start_ns = mono_now_ns();
+        dcf77_encode_range_parallel(header.first_utc_minute_ns + static_cast<int64_t>(done) * NS_PER_MINUTE, count,
+                                    block.data(), threads);
+        encode_ns += mono_now_ns() - start_ns;
+
+        if (std::fwrite(block.data(), sizeof(uint64_t), count, file) != count)
+        {
+            std::cerr << "Write to " << path << " failed\n";
+            std::fclose(file);
+            return 1;
+        }
+
+        done += count;
+    }
+
+    std::fclose(file);
+
+    print_rate("Encoded", header.count, encode_ns, threads);
+    return 0;
+}
+
+// Open a frame file and read its header, nullptr if it is not one
+static std::FILE *open_frame_file(const char *path, Dcf77BatchHeader &header)
+{
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return nullptr;
+    }
+
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, DCF77_BATCH_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DCF77_BATCH_VERSION)
+    {
+        std::cerr << path << " is not a DCF77 frame file\n";
+        std::fclose(file);
+        return nullptr;
+    }
+
+    return file;
+}
+
+static int validate(const char *path, unsigned threads)
+{
+    Dcf77BatchHeader header;
+    std::FILE *file = open_frame_file(path, header);
+    if (!file)
+        return 1;
+
+    std::vector<uint64_t> block(BLOCK_FRAMES);
+    Dcf77BatchCheck total;
+    total.first_invalid = header.count;
+    int64_t check_ns = 0;
+
+    for (uint64_t done = 0; done < header.count; )
+    {
+        const uint64_t count = header.count - done < BLOCK_FRAMES ? header.count - done : BLOCK_FRAMES;
+
+        if (std::fread(block.data(), sizeof(uint64_t), count, file) != count)
+        {
+            std::cerr << path << " is truncated at frame " << done << "\n";
+            std::fclose(file);
+            return 1;
+        }
+
+        const int64_t start_ns = mono_now_ns();
+        const Dcf77BatchCheck check = dcf77_check_range_parallel(
+            header.first_utc_minute_ns + static_cast<int64_t>(done) * NS_PER_MINUTE, count, block.data(), threads);
+        check_ns += mono_now_ns() - start_ns;
+
+        if (check.invalid && total.invalid == 0)
+            total.first_invalid = done + check.first_invalid;
+        total.invalid += check.invalid;
+
+        done += count;
+    }
+
+    std::fclose(file);
+
+    print_rate("Validated", header.count, check_ns, threads);
+
+    if (total.invalid)
+    {
+        std::cerr << total.invalid << " invalid frames, first at index " << total.first_invalid << "\n";
+        return 2;
+    }
+
+    std::cout << "All frames valid\n";
+    return 0;
+}
+
+static int bench(int first_year, int years, unsigned threads)
+{
+    const int64_t  first = year_start_ns(first_year);
+    const uint64_t count = minutes_in_years(first_year, years);
+
+    std::vector<uint64_t> frames(count);
+
+    // Touch the pages first, the measurement is encoding, not page faults
+    std::memset(frames.data(), 0, count * sizeof(uint64_t));
+
+    int64_t start_ns = mono_now_ns();
+    dcf77_encode_range_parallel(first, count, frames.data(), threads);
+    print_rate("Encoded", count, mono_now_ns() - start_ns, threads);
+
+    start_ns = mono_now_ns();
+    const Dcf77BatchCheck check = dcf77_check_range_parallel(first, count, frames.data(), threads);
+    print_rate("Validated", count, mono_now_ns() - start_ns, threads);
+
+    return check.invalid ? 2 : 0;
+}
+
+static int dump(const char *path, const char *text_path)
+{
+    Dcf77BatchHeader header;
+    std::FILE *file = open_frame_file(path, header);
+    if (!file)
+        return 1;
+
+    std::FILE *text = text_path ? std::fopen(text_path, "wb") : stdout;
+    if (!text)
+    {
+        std::cerr << "Cannot create " << text_path << "\n";
+        std::fclose(file);
+        return 1;
+    }
+
+    std::vector<uint64_t> block(BLOCK_FRAMES);
+    int rc = 0;
+
+    for (uint64_t done = 0; done < header.count && rc == 0; )
+    {
+        const uint64_t count = header.count - done < BLOCK_FRAMES ? header.count - done : BLOCK_FRAMES;
+
+        if (std::fread(block.data(), sizeof(uint64_t), count, file) != count)
+        {
+            std::cerr << path << " is truncated at frame " << done << "\n";
+            rc = 1;
+        }
+        else if (!dcf77_write_frames(text, block.data(), count))
+        {
+            std::cerr << "Write failed\n";
+            rc = 1;
+        }
+
+        done += count;
+    }
+
+    std::fclose(file);
+    if (text != stdout)
+        std::fclose(text);
+
+    return rc;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    ToolOptions options;
+    std::vector<const char *> args;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (options.threads == 0)
+        options.threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+    if (args.size() == 4 && std::strcmp(args[0], "generate") == 0)
+        return generate(std::atoi(args[1]), std::atoi(args[2]), args[3], options.threads);
+
+    if (args.size() == 2 && std::strcmp(args[0], "validate") == 0)
+        return validate(args[1], options.threads);
+
+    if (args.size() == 3 && std::strcmp(args[0], "bench") == 0)
+        return bench(std::atoi(args[1]), std::atoi(args[2]), options.threads);
+
+    if ((args.size() == 2 || args.size() == 3) && std::strcmp(args[0], "dump") == 0)
+        return dump(args[1], args.size() == 3 ? args[2] : nullptr);
+
+    usage(argv[0]);
+    return 1;
+}
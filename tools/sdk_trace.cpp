@@ -0,0 +1,410 @@
+// SDK call trace tool, traces are recorded with --trace-sdk
+//
+//   sdk_trace dump <trace>
+//   sdk_trace replay <trace> <out_trace> [--sim-latency <min_ms>:<max_ms>] [--sim-devices <n>] [--seed <n>]
+//   sdk_trace diff <trace_a> <trace_b>
+//
+// Replay is open loop: every call is issued at its recorded entry time, not
+// in response to what the previous call returned or when it returned. Each
+// recorded thread gets a thread of its own, but the calls to one device are
+// issued in their recorded order and never overlap, as the simulator requires:
+// a call whose predecessor on the device is still running waits for it.
+//
+// What diff can catch between a recording and its replay: calls this build's
+// shims or simulator no longer accept or answer differently (rc mismatches),
+// and how call durations change with the simulated latency. What it cannot:
+// any change in the transmitter's own timing or call pattern, the replay
+// issues the recorded calls whatever this build would have done. Its call time
+// shift is then the tool's sleep jitter plus waits for a busy device. Timing
+// regressions between builds show up only in diff of two recorded runs.
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "hantek_sdk.h"
+#include "hantek_sim.h"
+#include "latency_histogram.h"
+#include "mono_clock.h"
+#include "sdk_loader.h"
+#include "sdk_trace.h"
+
+//------------------------------------------------------------------------------
+
+const size_t REPLAY_SCRATCH_BYTES = 256;        // output buffers: device info, names and serials
+
+struct ToolOptions
+{
+    SimConfig sim;
+};
+
+static void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " dump <trace>\n"
+              << "       " << argv0 << " replay <trace> <out_trace> [--sim-latency <min_ms>:<max_ms>]"
+                                       " [--sim-devices <n>] [--seed <n>]\n"
+              << "       " << argv0 << " diff <trace_a> <trace_b>\n";
+}
+
+static double ns_to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / NS_PER_MS;
+}
+
+//------------------------------------------------------------------------------
+
+// Recorded arguments back into the entry point's types. Pointers get a
+// scratch buffer, the calls only fill it in.
+template <typename T>
+T replay_arg(double value)
+{
+    if constexpr (std::is_pointer<T>::value)
+    {
+        alignas(8) static thread_local unsigned char scratch[REPLAY_SCRATCH_BYTES];
+        (void)value;
+        return reinterpret_cast<T>(scratch);
+    }
+    else
+    {
+        return static_cast<T>(value);
+    }
+}
+
+typedef double (*ReplayCall)(const double *args);
+
+// Calls the simulated entry point through the same recording shim as the transmitter
+template <SdkExport ID, typename Fn>
+struct SdkReplay;
+
+template <SdkExport ID, typename R, typename... Args>
+struct SdkReplay<ID, R (WINAPI *)(Args...)>
+{
+    static double call(const double *args)
+    {
+        return invoke(args, std::index_sequence_for<Args...>());
+    }
+
+    template <size_t... I>
+    static double invoke(const double *args, std::index_sequence<I...>)
+    {
+        (void)args;
+        return sdk_trace_arg(SdkTraced<ID, R (WINAPI *)(Args...)>::call(replay_arg<Args>(args[I])...));
+    }
+};
+
+static void bind_replay(ReplayCall (&calls)[SDK_EXPORT_COUNT])
+{
+    for (ReplayCall &call : calls)
+        call = nullptr;
+
+#define SDK_BIND_REPLAY(name, required)                                             \
+    SdkTraced<SdkExport::name, PFN_##name>::next = sim_##name;                      \
+    calls[static_cast<size_t>(SdkExport::name)] = SdkReplay<SdkExport::name, PFN_##name>::call;
+    SDK_USED_EXPORTS(SDK_BIND_REPLAY)
+#undef SDK_BIND_REPLAY
+}
+
+// Calls to one device go out one at a time in recorded order, by turn
+struct DeviceTurn
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    uint64_t next = 0;
+};
+
+struct ReplayStep
+{
+    const SdkTraceRecord *record;
+    DeviceTurn *device;
+    uint64_t turn;          // position among the device's recorded calls
+};
+
+// Recorded call order across threads, ties broken the same way everywhere
+static bool called_before(const SdkTraceRecord *a, const SdkTraceRecord *b)
+{
+    return a->entry_ns != b->entry_ns ? a->entry_ns < b->entry_ns : a->thread < b->thread;
+}
+
+// One recorded thread: its calls in order, each issued at its recorded entry
+// time whatever the previous call returned, or once the device is free
+static void replay_thread(const std::vector<ReplayStep> &steps, const ReplayCall *calls, int64_t start_ns)
+{
+    for (const ReplayStep &step : steps)
+    {
+        sleep_until_ns(start_ns + step.record->entry_ns);
+
+        DeviceTurn &device = *step.device;
+        {
+            std::unique_lock<std::mutex> lock(device.mutex);
+            device.done.wait(lock, [&] { return device.next == step.turn; });
+        }
+
+        calls[step.record->export_id](step.record->args);
+
+        {
+            std::lock_guard<std::mutex> lock(device.mutex);
+            ++device.next;
+        }
+        device.done.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+static int dump(const char *path)
+{
+    SdkTraceHeader header;
+    std::vector<SdkTraceRecord> records;
+    if (!sdk_trace_read(path, header, records))
+        return 1;
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    for (const SdkTraceRecord &record : records)
+    {
+        const char *name = record.export_id < SDK_EXPORT_COUNT
+                               ? sdk_export_name(static_cast<SdkExport>(record.export_id)) : "?";
+
+        std::cout << std::setw(12) << ns_to_ms(record.entry_ns) << " ms +" << std::setw(8)
+                  << ns_to_ms(record.exit_ns - record.entry_ns) << " ms [" << record.thread << "] "
+                  << name << "(" << std::defaultfloat << std::setprecision(10);
+
+        for (uint8_t i = 0; i < record.arg_count && i < SDK_TRACE_MAX_ARGS; ++i)
+            std::cout << (i ? ", " : "") << record.args[i];
+
+        std::cout << ") rc = " << record.rc << std::fixed << std::setprecision(3) << "\n";
+    }
+
+    std::cout << std::defaultfloat << records.size() << " calls\n";
+    return 0;
+}
+
+static int replay(const char *path, const char *out_path, const ToolOptions &options)
+{
+    SdkTraceHeader header;
+    std::vector<SdkTraceRecord> records;
+    if (!sdk_trace_read(path, header, records))
+        return 1;
+
+    ReplayCall calls[SDK_EXPORT_COUNT];
+    bind_replay(calls);
+
+    // Per recorded thread, in the order the calls were made
+    std::vector<std::vector<const SdkTraceRecord *>> threads;
+    uint64_t skipped = 0;
+
+    for (const SdkTraceRecord &record : records)
+    {
+        if (record.export_id >= SDK_EXPORT_COUNT || !calls[record.export_id])
+        {
+            ++skipped;
+            continue;
+        }
+
+        if (threads.size() <= record.thread)
+            threads.resize(record.thread + 1u);
+        threads[record.thread].push_back(&record);
+    }
+
+    for (std::vector<const SdkTraceRecord *> &thread : threads)
+        std::sort(thread.begin(), thread.end(), called_before);
+
+    // Every export the transmitter calls takes the device index first, the
+    // search call's pointer reads as device 0
+    std::map<int, std::vector<const SdkTraceRecord *>> by_device;
+    for (const std::vector<const SdkTraceRecord *> &thread : threads)
+    {
+        for (const SdkTraceRecord *record : thread)
+            by_device[static_cast<int>(record->args[0])].push_back(record);
+    }
+
+    std::map<int, std::unique_ptr<DeviceTurn>> devices;
+    std::map<const SdkTraceRecord *, ReplayStep> step_of;
+    for (auto &device : by_device)
+    {
+        std::sort(device.second.begin(), device.second.end(), called_before);
+        devices[device.first].reset(new DeviceTurn());
+
+        for (size_t i = 0; i < device.second.size(); ++i)
+            step_of[device.second[i]] = {device.second[i], devices[device.first].get(), i};
+    }
+
+    std::vector<std::vector<ReplayStep>> steps(threads.size());
+    for (size_t t = 0; t < threads.size(); ++t)
+    {
+        for (const SdkTraceRecord *record : threads[t])
+            steps[t].push_back(step_of[record]);
+    }
+
+    sim_configure(options.sim);
+
+    if (!sdk_trace_open(out_path))
+        return 1;
+
+    std::cout << "Replaying " << records.size() - skipped << " calls on " << threads.size()
+              << " threads against the simulated device, SDK call latency " << ns_to_ms(options.sim.latency_min_ns)
+              << "-" << ns_to_ms(options.sim.latency_max_ns) << " ms\n";
+
+    // A little head room so the first calls are not late already
+    const int64_t start_ns = mono_now_ns() + 10 * NS_PER_MS;
+
+    std::vector<std::thread> workers;
+    for (const std::vector<ReplayStep> &thread : steps)
+        workers.emplace_back(replay_thread, std::cref(thread), calls, start_ns);
+
+    for (std::thread &worker : workers)
+        worker.join();
+
+    const SdkTraceStats stats = sdk_trace_close();
+    std::cout << stats.records << " calls written to " << out_path << ", " << stats.dropped << " dropped, "
+              << skipped << " not replayable\n";
+
+    return stats.dropped ? 2 : 0;
+}
+
+//------------------------------------------------------------------------------
+
+// Calls of one export in a trace, in entry order
+static std::vector<const SdkTraceRecord *> calls_of(const std::vector<SdkTraceRecord> &records, uint16_t export_id)
+{
+    std::vector<const SdkTraceRecord *> calls;
+    for (const SdkTraceRecord &record : records)
+    {
+        if (record.export_id == export_id)
+            calls.push_back(&record);
+    }
+
+    std::sort(calls.begin(), calls.end(),
+              [](const SdkTraceRecord *a, const SdkTraceRecord *b) { return a->entry_ns < b->entry_ns; });
+    return calls;
+}
+
+static LatencyPercentiles percentiles_of(const LatencyHistogram &histogram)
+{
+    std::unique_ptr<LatencyHistogram::Snapshot> snapshot(new LatencyHistogram::Snapshot());
+    histogram.snapshot(*snapshot);
+    return latency_percentiles(*snapshot);
+}
+
+static void print_percentiles(const LatencyPercentiles &p)
+{
+    std::cout << ns_to_ms(p.p50_ns) << "/" << ns_to_ms(p.p99_ns) << "/" << ns_to_ms(p.max_ns);
+}
+
+// Per export: call counts, rc mismatches, call duration percentiles of both
+// traces and how far the n-th call of B moved against the n-th call of A,
+// both measured from their export's first call. Against a replay the shift
+// is only the replay's own jitter, see the top of this file.
+static int diff(const char *path_a, const char *path_b)
+{
+    SdkTraceHeader header_a;
+    SdkTraceHeader header_b;
+    std::vector<SdkTraceRecord> a;
+    std::vector<SdkTraceRecord> b;
+    if (!sdk_trace_read(path_a, header_a, a) || !sdk_trace_read(path_b, header_b, b))
+        return 1;
+
+    bool same = true;
+
+    std::cout << "export: calls A/B, rc mismatches, duration p50/p99/max A -> B ms, call time shift p50/p99/max ms\n";
+
+    for (uint16_t id = 0; id < SDK_EXPORT_COUNT; ++id)
+    {
+        const std::vector<const SdkTraceRecord *> calls_a = calls_of(a, id);
+        const std::vector<const SdkTraceRecord *> calls_b = calls_of(b, id);
+
+        if (calls_a.empty() && calls_b.empty())
+            continue;
+
+        std::unique_ptr<LatencyHistogram> duration_a(new LatencyHistogram());
+        std::unique_ptr<LatencyHistogram> duration_b(new LatencyHistogram());
+        std::unique_ptr<LatencyHistogram> shift(new LatencyHistogram());
+
+        for (const SdkTraceRecord *record : calls_a)
+            duration_a->record(record->exit_ns - record->entry_ns);
+        for (const SdkTraceRecord *record : calls_b)
+            duration_b->record(record->exit_ns - record->entry_ns);
+
+        const size_t matched = std::min(calls_a.size(), calls_b.size());
+        uint64_t rc_mismatches = 0;
+
+        for (size_t i = 0; i < matched; ++i)
+        {
+            const int64_t since_a = calls_a[i]->entry_ns - calls_a[0]->entry_ns;
+            const int64_t since_b = calls_b[i]->entry_ns - calls_b[0]->entry_ns;
+
+            shift->record(std::llabs(since_b - since_a));
+            if (calls_a[i]->rc != calls_b[i]->rc)
+                ++rc_mismatches;
+        }
+
+        same = same && calls_a.size() == calls_b.size() && rc_mismatches == 0;
+
+        std::cout << "  " << sdk_export_name(static_cast<SdkExport>(id)) << ": " << calls_a.size() << "/"
+                  << calls_b.size() << ", " << rc_mismatches << ", ";
+        print_percentiles(percentiles_of(*duration_a));
+        std::cout << " -> ";
+        print_percentiles(percentiles_of(*duration_b));
+        std::cout << ", ";
+        print_percentiles(percentiles_of(*shift));
+        std::cout << "\n";
+    }
+
+    std::cout << (same ? "Same calls and return codes in both traces\n" : "The traces differ in calls or return codes\n");
+    return same ? 0 : 2;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    ToolOptions options;
+    std::vector<const char *> args;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--sim-latency") == 0 && i + 1 < argc)
+        {
+            char *end = nullptr;
+            options.sim.latency_min_ns = static_cast<int64_t>(std::strtod(argv[++i], &end) * NS_PER_MS);
+            options.sim.latency_max_ns = (*end == ':') ? static_cast<int64_t>(std::strtod(end + 1, nullptr) * NS_PER_MS)
+                                                       : options.sim.latency_min_ns;
+        }
+        else if (std::strcmp(argv[i], "--sim-devices") == 0 && i + 1 < argc)
+            options.sim.devices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            options.sim.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (options.sim.devices > DEVICE_SLOTS || options.sim.latency_min_ns < 0 ||
+        options.sim.latency_max_ns < options.sim.latency_min_ns)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (args.size() == 2 && std::strcmp(args[0], "dump") == 0)
+        return dump(args[1]);
+
+    if (args.size() == 3 && std::strcmp(args[0], "replay") == 0)
+        return replay(args[1], args[2], options);
+
+    if (args.size() == 3 && std::strcmp(args[0], "diff") == 0)
+        return diff(args[1], args[2]);
+
+    usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,369 @@
+// Offline analyzer of the daily transmit traces written with --tx-trace
+//
+//   tx_analyze [--late-ms <ms>] [--frames] <trace>...
+//
+// Files are read as one stream in the given order, pass them oldest first.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dcf77_encoder.h"
+#include "dcf77_frame.h"
+#include "edge_scheduler.h"
+#include "hantek_sdk.h"
+#include "latency_histogram.h"
+#include "mono_clock.h"
+#include "pulse_program.h"
+#include "tx_trace.h"
+#include "utc_clock.h"
+
+//------------------------------------------------------------------------------
+
+const uint32_t MODULATED_SECONDS    = 59;
+const size_t   MAX_LISTED_EDGES     = 20;   // late or failed edges printed one by one
+
+// Only the nominal widths matter to pulse_width_to_bit
+const PulseLevels PULSE_WIDTHS      = {0, 0, 100 * NS_PER_MS, 200 * NS_PER_MS};
+
+struct ToolOptions
+{
+    int64_t late_ns = 2 * NS_PER_MS;
+    bool    frames  = false;
+};
+
+// Edges of one transmitted minute by second and PulseEdge
+struct Minute
+{
+    const TxTraceRecord *frame;
+    const TxTraceRecord *edges[MODULATED_SECONDS][2];  // [second][PulseEdge START / END]
+    uint64_t log_dropped;   // records the transmitter lost before they reached the trace
+};
+
+struct Analysis
+{
+    uint64_t records = 0;
+    uint64_t edges   = 0;
+    uint64_t frames  = 0;
+    uint64_t runs    = 0;
+    uint64_t orphan_edges   = 0;    // before the first frame
+    uint64_t failed_edges   = 0;    // rc != HT_OK
+    uint64_t late_edges     = 0;
+    uint64_t missed_edges   = 0;    // absent, unless only the end of a run's or the stream's last minute
+    uint64_t log_dropped    = 0;    // records the transmitter's log ring dropped
+    uint64_t unlogged_edges = 0;    // absent from a minute with dropped records, maybe sent
+    uint64_t decoded        = 0;    // minutes whose edges decode to the recorded frame
+    uint64_t mismatched     = 0;    // ... to another frame
+    uint64_t undecodable    = 0;    // ... to nothing, an edge missing or a width out of range
+    uint64_t incomplete     = 0;    // ... not as sent, but records of the minute were dropped
+    size_t   listed         = 0;
+
+    EdgeLatenessStats error;        // actual - planned
+    std::unique_ptr<LatencyHistogram> abs_error{new LatencyHistogram()};
+};
+
+static void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [--late-ms <ms>] [--frames] <trace>...\n";
+}
+
+static double ns_to_ms(int64_t ns)
+{
+    return static_cast<double>(ns) / NS_PER_MS;
+}
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// 2025-11-24 21:47:59.123 UTC
+static std::string utc_to_string(int64_t utc_ns)
+{
+    const int64_t ms_total = floor_div(utc_ns, NS_PER_MS);
+    const int64_t day_ms   = 86400 * 1000;
+    const int64_t days     = floor_div(ms_total, day_ms);
+    const int64_t ms       = ms_total - days * day_ms;
+    const CivilDate date   = civil_from_days(days);
+
+    char text[40];
+    std::snprintf(text, sizeof(text), "%04d-%02u-%02u %02d:%02d:%02d.%03d", date.year, date.month, date.day,
+                  static_cast<int>(ms / 3600000), static_cast<int>(ms / 60000 % 60), static_cast<int>(ms / 1000 % 60),
+                  static_cast<int>(ms % 1000));
+    return text;
+}
+
+//------------------------------------------------------------------------------
+
+static void list_edge(Analysis &analysis, const TxTraceRecord &edge, const char *what)
+{
+    if (analysis.listed++ >= MAX_LISTED_EDGES)
+        return;
+
+    std::cout << "  " << what << " " << (edge.edge == PULSE_EDGE_START ? "start" : "end") << " of second "
+              << static_cast<int>(edge.bit_index) << " at " << utc_to_string(edge.planned_utc_ns) << " UTC, error "
+              << ns_to_ms(edge.actual_utc_ns - edge.planned_utc_ns) << " ms, rc = " << edge.rc << "\n";
+}
+
+static void add_edge(Analysis &analysis, Minute *minute, const TxTraceRecord &edge, const ToolOptions &options)
+{
+    ++analysis.edges;
+
+    const int64_t error_ns = edge.actual_utc_ns - edge.planned_utc_ns;
+    analysis.error.add(error_ns);
+    analysis.abs_error->record(error_ns < 0 ? -error_ns : error_ns);
+
+    if (edge.rc != HT_OK)
+    {
+        ++analysis.failed_edges;
+        list_edge(analysis, edge, "failed");
+    }
+    else if (error_ns > options.late_ns || error_ns < -options.late_ns)
+    {
+        ++analysis.late_edges;
+        list_edge(analysis, edge, "late");
+    }
+
+    if (!minute)
+    {
+        ++analysis.orphan_edges;
+        return;
+    }
+
+    if (edge.bit_index < MODULATED_SECONDS && edge.edge <= PULSE_EDGE_END)
+        minute->edges[edge.bit_index][edge.edge] = &edge;
+}
+
+// Rebuild the frame from the pulse widths as a receiver would and compare it
+// with the one the transmitter meant to send
+static void finish_minute(Analysis &analysis, const Minute &minute, bool complete, const ToolOptions &options)
+{
+    uint64_t air_bits  = 0;
+    uint32_t missing   = 0;
+    uint32_t trailing  = 0;     // missing after the last edge seen
+    bool     decodable = true;
+
+    for (uint32_t second = 0; second < MODULATED_SECONDS; ++second)
+    {
+        const TxTraceRecord *start = minute.edges[second][PULSE_EDGE_START];
+        const TxTraceRecord *end   = minute.edges[second][PULSE_EDGE_END];
+
+        for (const TxTraceRecord *edge : {start, end})
+        {
+            if (edge)
+            {
+                missing += trailing;
+                trailing = 0;
+            }
+            else
+            {
+                ++trailing;
+            }
+        }
+
+        if (!start || !end)
+        {
+            decodable = false;
+            continue;
+        }
+
+        const int bit = pulse_width_to_bit(end->actual_utc_ns - start->actual_utc_ns, PULSE_WIDTHS);
+        if (bit < 0)
+            decodable = false;
+        else
+            air_bits |= static_cast<uint64_t>(bit) << second;
+    }
+
+    // The last minute of the stream may simply not be over yet
+    if (complete)
+    {
+        missing += trailing;
+        trailing = 0;
+    }
+    // Edges lost with the log records may well have been sent
+    if (minute.log_dropped)
+        analysis.unlogged_edges += missing;
+    else
+        analysis.missed_edges += missing;
+
+    const uint64_t decoded = dcf77_from_air_order(air_bits);
+    const bool     matches = decodable && decoded == minute.frame->frame_bits;
+
+    if (!matches && minute.log_dropped)
+        ++analysis.incomplete;
+    else if (!decodable)
+        ++analysis.undecodable;
+    else if (matches)
+        ++analysis.decoded;
+    else
+        ++analysis.mismatched;
+
+    if (!options.frames)
+        return;
+
+    std::cout << utc_to_string(minute.frame->actual_utc_ns) << " UTC sent "
+              << dcf77_frame_to_string(minute.frame->frame_bits);
+
+    if (!matches && minute.log_dropped)
+        std::cout << ", " << minute.log_dropped << " log records dropped, " << missing << " edges missing\n";
+    else if (!decodable)
+        std::cout << ", not decodable (" << missing << " edges missing" << (trailing ? ", minute unfinished" : "")
+                  << ")\n";
+    else if (!matches)
+        std::cout << ", decoded " << dcf77_frame_to_string(decoded) << " MISMATCH\n";
+    else if (dcf77_frame_valid(decoded))
+        std::cout << ", decoded ok, announces " << utc_to_string(dcf77_frame_utc_minute_ns(decoded)) << " UTC\n";
+    else
+        std::cout << ", decoded ok\n";
+}
+
+// Header of a trace file mapped read only, null with a message if it is not one
+static const TxTraceHeader *open_trace(const char *path, MappedFile &file)
+{
+    if (!file.open(path, false))
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return nullptr;
+    }
+
+    const TxTraceHeader *header = tx_trace_header(file);
+    if (!header)
+        std::cerr << path << " is not a transmit trace\n";
+    return header;
+}
+
+// A minute spanning midnight continues in the next file
+static void analyze_trace(const TxTraceHeader *header, Analysis &analysis, Minute &minute, bool &in_minute,
+                          const ToolOptions &options)
+{
+    const TxTraceRecord *records = tx_trace_records(header);
+
+    for (uint64_t i = 0; i < header->count; ++i)
+    {
+        const TxTraceRecord &record = records[i];
+
+        if (record.kind == TX_TRACE_RUN_START)
+        {
+            // The previous run stopped, its last minute was cut short
+            if (in_minute)
+                finish_minute(analysis, minute, false, options);
+
+            in_minute = false;
+            ++analysis.runs;
+        }
+        else if (record.kind == TX_TRACE_FRAME)
+        {
+            if (in_minute)
+                finish_minute(analysis, minute, true, options);
+
+            minute = Minute();
+            minute.frame = &record;
+            in_minute = true;
+            ++analysis.frames;
+        }
+        else if (record.kind == TX_TRACE_EDGE)
+        {
+            add_edge(analysis, in_minute ? &minute : nullptr, record, options);
+        }
+        else if (record.kind == TX_TRACE_DROPPED)
+        {
+            // The lost records lie between the previous record and this one
+            analysis.log_dropped += record.frame_bits;
+            if (in_minute)
+                minute.log_dropped += record.frame_bits;
+        }
+    }
+
+    analysis.records += header->count;
+}
+
+static void print_analysis(const Analysis &analysis, const ToolOptions &options)
+{
+    std::unique_ptr<LatencyHistogram::Snapshot> snapshot(new LatencyHistogram::Snapshot());
+    analysis.abs_error->snapshot(*snapshot);
+    const LatencyPercentiles p = latency_percentiles(*snapshot);
+
+    std::cout << analysis.records << " records, " << analysis.edges << " edges, " << analysis.frames << " frames, "
+              << analysis.runs << " transmitter runs\n";
+
+    if (analysis.edges)
+        std::cout << "Edge error min/avg/max " << ns_to_ms(analysis.error.min_ns) << "/"
+                  << ns_to_ms(analysis.error.mean_ns()) << "/" << ns_to_ms(analysis.error.max_ns)
+                  << " ms, |error| p50/p99/p99.9/max " << ns_to_ms(p.p50_ns) << "/" << ns_to_ms(p.p99_ns) << "/"
+                  << ns_to_ms(p.p999_ns) << "/" << ns_to_ms(p.max_ns) << " ms\n";
+
+    std::cout << "Edges late by more than " << ns_to_ms(options.late_ns) << " ms: " << analysis.late_edges
+              << ", failed: " << analysis.failed_edges << ", missed: " << analysis.missed_edges
+              << ", before the first frame: " << analysis.orphan_edges << "\n";
+
+    if (analysis.log_dropped)
+        std::cout << "Log records dropped by the transmitter: " << analysis.log_dropped << ", edges absent from "
+                  << "those minutes (not counted as missed): " << analysis.unlogged_edges << "\n";
+
+    std::cout << "Minutes decoded from the edges: " << analysis.decoded << " as sent, " << analysis.mismatched
+              << " differently, " << analysis.undecodable << " not decodable, " << analysis.incomplete
+              << " with dropped log records\n";
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    ToolOptions options;
+    std::vector<const char *> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--late-ms") == 0 && i + 1 < argc)
+            options.late_ns = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * NS_PER_MS);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            options.frames = true;
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if (paths.empty())
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int64_t start_ns = mono_now_ns();
+
+    // All files stay mapped, a minute may refer to records of two of them
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<const TxTraceHeader *> headers;
+
+    for (const char *path : paths)
+    {
+        files.emplace_back(new MappedFile());
+        headers.push_back(open_trace(path, *files.back()));
+        if (!headers.back())
+            return 1;
+    }
+
+    Analysis analysis;
+    Minute minute = Minute();
+    bool in_minute = false;
+
+    for (const TxTraceHeader *header : headers)
+        analyze_trace(header, analysis, minute, in_minute, options);
+
+    if (in_minute)
+        finish_minute(analysis, minute, false, options);
+
+    const uint64_t bytes = analysis.records * sizeof(TxTraceRecord);
+    const double seconds = static_cast<double>(mono_now_ns() - start_ns) / NS_PER_S;
+
+    print_analysis(analysis, options);
+    std::cout << "Analyzed " << paths.size() << " files in " << seconds << " s ("
+              << (seconds > 0 ? static_cast<double>(bytes) / seconds / 1e6 : 0.0) << " MB/s)\n";
+
+    return analysis.failed_edges || analysis.missed_edges || analysis.mismatched ? 2 : 0;
+}